@@ -0,0 +1,259 @@
+#!/usr/bin/env python3
+"""
+Compile cost of the TinyMock headers.
+
+Generates N mock classes of M methods each, written the way
+Tests/Helpers/TestMock.cpp writes them, one translation unit per mock, and
+builds them into a program that sets up and makes every call once. For the
+header-only build and for the TINYMOCK_LEAN build against src/TinyMock.cpp it
+reports:
+
+- the compile time and object size of every translation unit,
+- the size of the linked program,
+- how many distinct Method types and Method vtables the program has, and how
+  many copies of them the objects carried before the linker folded them.
+
+	python3 Benchmarks/CompileCost.py --mocks 20 --methods 10
+	CXX=clang++ python3 Benchmarks/CompileCost.py --mode lean --flags "-O0 -g"
+"""
+
+import argparse
+import os
+import re
+import shlex
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+# Argument types and return type of the generated methods, in turn, so that
+# a mock uses the shapes of Method a real interface does.
+SHAPES = [
+	([], "void"),
+	(["int"], "void"),
+	([], "int"),
+	(["int", "int"], "void"),
+	(["std::string"], "bool"),
+	(["int", "bool", "double"], "void"),
+	(["long", "int", "int", "int"], "int"),
+	(["double"], "std::string"),
+]
+
+VALUES = {
+	"int": "1",
+	"long": "2L",
+	"bool": "true",
+	"double": "0.5",
+	"std::string": "std::string(\"x\")",
+}
+
+METHOD_TYPE = re.compile(r"TinyMock::(?:Method|MethodIgnoringArguments|MethodWithDereferencedArguments)<")
+
+
+def method_type(parameters, result):
+	return "TinyMock::Method<%s>" % ",".join(parameters + ["void"] * (4 - len(parameters)) + [result])
+
+
+def constructor_arguments(name, values, result):
+	arguments = ['"%s"' % name] + values
+	if result != "void":
+		arguments.append(VALUES[result])
+	return ",".join(arguments)
+
+
+def generate_mock(directory, index, methods):
+	name = "Mock%d" % index
+	declarations = []
+	definitions = []
+	expectations = []
+	calls = []
+	for m in range(methods):
+		parameters, result = SHAPES[(index + m) % len(SHAPES)]
+		method = "Method%d" % m
+		formal = ", ".join("%s p%d" % (p, i + 1) for i, p in enumerate(parameters))
+		actual = ["p%d" % (i + 1) for i in range(len(parameters))]
+		values = [VALUES[p] for p in parameters]
+		mocked = method_type(parameters, result)
+		declarations.append("\tvirtual %s %s(%s) = 0;" % (result, method, formal))
+		body = [
+			"%s %s::%s(%s)" % (result, name, method, formal),
+			"{",
+			"\t%s actual(%s);" % (mocked, constructor_arguments(method, actual, result)),
+			"\tTinyMock::BaseMethod* expected = m_expectations.GetFirstExpectationFor(actual.Signature());",
+		]
+		if result != "void":
+			body.append("\t%s ret = expected ? ((%s*)expected)->m_r : %s() ;" % (result, mocked, result))
+		body.append("\tHandle(expected,(TinyMock::BaseMethod*)&actual);")
+		if result != "void":
+			body.append("\treturn ret ;")
+		body.append("}")
+		definitions.append("\n".join(body))
+		expectations.append("\tmock->RegisterExpectation(new %s(%s));" % (mocked, constructor_arguments(method, values, result)))
+		calls.append("\tmock->%s(%s);" % (method, ", ".join(values)))
+	overrides = [d.replace("\tvirtual ", "\t").replace(" = 0;", ";") for d in declarations]
+	source = "\n".join([
+		'#include <string>',
+		'#include "TinyMock.h"',
+		'',
+		"class %sInterface" % name,
+		"{",
+		"public:",
+		"\tvirtual ~%sInterface() {}" % name,
+	] + declarations + [
+		"};",
+		"",
+		"class %s : public %sInterface, public TinyMock::Mock" % (name, name),
+		"{",
+		"public:",
+		"\t%s(const std::string& className) : TinyMock::Mock(className) {}" % name,
+	] + overrides + [
+		"};",
+		"",
+	] + definitions + [
+		"",
+		"bool Run%s()" % name,
+		"{",
+		"\tTinyMock::MockRepository<> repository ;",
+		'\t%s* mock = repository.CreateMockWithoutFailureNotifier<%s>("%s");' % (name, name, name),
+	] + expectations + calls + [
+		"\treturn repository.verifyAll();",
+		"}",
+		"",
+	])
+	path = os.path.join(directory, name + ".cpp")
+	with open(path, "w") as f:
+		f.write(source)
+	return path
+
+
+def generate_main(directory, mocks):
+	lines = ["bool Run%s();" % ("Mock%d" % i) for i in range(mocks)]
+	lines += ["", "int main()", "{", "\tbool passed = true ;"]
+	lines += ["\tpassed = Run%s() && passed ;" % ("Mock%d" % i) for i in range(mocks)]
+	lines += ["\treturn passed ? 0 : 1 ;", "}", ""]
+	path = os.path.join(directory, "main.cpp")
+	with open(path, "w") as f:
+		f.write("\n".join(lines))
+	return path
+
+
+def run(command):
+	process = subprocess.run(command, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+	if process.returncode != 0:
+		sys.stderr.write(" ".join(shlex.quote(c) for c in command) + "\n" + process.stdout)
+		sys.exit(1)
+	return process.stdout
+
+
+def text_size(path):
+	if shutil.which("size"):
+		lines = run(["size", path]).splitlines()
+		if len(lines) > 1:
+			return int(lines[1].split()[0])
+	return os.path.getsize(path)
+
+
+def method_types(symbol):
+	"""The Method types a demangled symbol names."""
+	types = []
+	for match in METHOD_TYPE.finditer(symbol):
+		depth = 0
+		for end in range(match.end() - 1, len(symbol)):
+			if symbol[end] == "<":
+				depth += 1
+			elif symbol[end] == ">":
+				depth -= 1
+				if depth == 0:
+					types.append(symbol[match.start():end + 1])
+					break
+	return types
+
+
+def method_symbols(path):
+	"""Distinct Method types and Method vtables defined in an object or program."""
+	instantiated = set()
+	vtables = set()
+	for line in run(["nm", "-C", "--defined-only", path]).splitlines():
+		parts = line.split(" ", 2)
+		if len(parts) < 3:
+			continue
+		symbol = parts[2]
+		if symbol.startswith("vtable for "):
+			for t in method_types(symbol)[:1]:
+				vtables.add(t)
+		instantiated.update(method_types(symbol)[:1])
+	return instantiated, vtables
+
+
+def build(mode, sources, directory, compiler, flags):
+	objects = []
+	rows = []
+	defines = ["-DTINYMOCK_LEAN"] if mode == "lean" else []
+	if mode == "lean":
+		sources = sources + [os.path.join(ROOT, "src", "TinyMock.cpp")]
+	for source in sources:
+		obj = os.path.join(directory, "%s.%s.o" % (os.path.basename(source), mode))
+		start = time.time()
+		run([compiler] + flags + defines + ["-I", os.path.join(ROOT, "include"), "-c", source, "-o", obj])
+		rows.append((os.path.basename(source), time.time() - start, text_size(obj)))
+		objects.append(obj)
+	program = os.path.join(directory, "program." + mode)
+	run([compiler] + flags + objects + ["-o", program, "-pthread"])
+	run([program])
+
+	copies = 0
+	vtable_copies = 0
+	for obj in objects:
+		instantiated, vtables = method_symbols(obj)
+		copies += len(instantiated)
+		vtable_copies += len(vtables)
+	instantiated, vtables = method_symbols(program)
+
+	print("%s build" % ("header-only" if mode == "header" else "lean"))
+	print("  %-16s %10s %14s" % ("translation unit", "compile", "object text"))
+	for name, seconds, size in rows:
+		print("  %-16s %8.2f s %12d B" % (name, seconds, size))
+	total = sum(r[1] for r in rows)
+	print("  compile total %.2f s, mean %.2f s, max %.2f s" % (total, total / len(rows), max(r[1] for r in rows)))
+	print("  objects %d B of text, program %d B (%d B of text)" % (sum(r[2] for r in rows), os.path.getsize(program), text_size(program)))
+	print("  Method types: %d in the program, %d copies in the objects" % (len(instantiated), copies))
+	print("  Method vtables: %d in the program, %d copies in the objects" % (len(vtables), vtable_copies))
+	print("")
+	return total, text_size(program)
+
+
+def main():
+	parser = argparse.ArgumentParser(description="Compile cost of mocks written with TinyMock.")
+	parser.add_argument("--mocks", type=int, default=20, help="number of mock classes, one per translation unit")
+	parser.add_argument("--methods", type=int, default=10, help="number of methods per mock")
+	parser.add_argument("--mode", choices=["header", "lean", "both"], default="both")
+	parser.add_argument("--flags", default="-std=gnu++17 -O2", help="compiler flags")
+	parser.add_argument("--keep", metavar="DIR", help="generate and build in DIR and keep it")
+	arguments = parser.parse_args()
+
+	compiler = os.environ.get("CXX", "g++")
+	flags = shlex.split(arguments.flags)
+	directory = arguments.keep or tempfile.mkdtemp(prefix="tinymock-compile-cost-")
+	if not os.path.isdir(directory):
+		os.makedirs(directory)
+	try:
+		sources = [generate_mock(directory, i, arguments.methods) for i in range(arguments.mocks)]
+		sources.append(generate_main(directory, arguments.mocks))
+		print("%d mocks x %d methods, %s %s" % (arguments.mocks, arguments.methods, compiler, arguments.flags))
+		print("")
+		results = {}
+		for mode in (["header", "lean"] if arguments.mode == "both" else [arguments.mode]):
+			results[mode] = build(mode, sources, directory, compiler, flags)
+		if len(results) == 2:
+			print("lean / header-only: compile time %.2f, program text %.2f" % (
+				results["lean"][0] / results["header"][0], float(results["lean"][1]) / results["header"][1]))
+	finally:
+		if not arguments.keep:
+			shutil.rmtree(directory)
+
+
+if __name__ == "__main__":
+	main()
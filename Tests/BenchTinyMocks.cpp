@@ -0,0 +1,64 @@
+#include <string>
+
+#include "yaffut.h"
+#include "TinyMock.h"
+using namespace TinyMock;
+
+#include "ConcreteNotifier.h"
+#include "TestMock.h"
+
+class BenchStaticMock : public StaticMock<BenchStaticMock>
+{
+public:
+	BenchStaticMock(const std::string& className)
+		: StaticMock<BenchStaticMock>(className), testMethodWithAnArgument(*this, "TestMethodWithAnArgument")
+	{
+	}
+	void TestMethodWithAnArgument(int arg) { testMethodWithAnArgument(arg); }
+
+	StaticMethod<BenchStaticMock, void(int)> testMethodWithAnArgument ;
+};
+
+// One repository for all the operations of a bench; every operation meets
+// the expectation it registers.
+struct BenchTinyMocks
+{
+    BenchTinyMocks()
+    {
+		testMock = mockRepository.CreateMock<TestMock,ConcreteNotifier>("TestMock");
+		staticMock = mockRepository.CreateMock<BenchStaticMock,ConcreteNotifier>("BenchStaticMock");
+    }
+
+    ~BenchTinyMocks()
+    {
+		mockRepository.verifyAll();
+    }
+
+	MockRepository<ConcreteNotifier> mockRepository ;
+	TestMock* testMock ;
+	BenchStaticMock* staticMock ;
+};
+
+BENCH(BenchTinyMocks,BenchExpectedCallWithAnArgument)
+{
+	testMock->RegisterExpectation(new TinyMock::Method<int,void,void,void,void>("TestMethodWithAnArgument",5));
+	testMock->TestMethodWithAnArgument(5);
+}
+
+BENCH(BenchTinyMocks,BenchExpectedCallWithAReturnValue)
+{
+	testMock->RegisterExpectation(new TinyMock::Method<void,void,void,void,int>("TestMethodWithReturnValue",7));
+	yaffut::DoNotOptimize(testMock->TestMethodWithReturnValue());
+}
+
+BENCH(BenchTinyMocks,BenchStaticExpectedCall)
+{
+	staticMock->testMethodWithAnArgument.Expect(5);
+	staticMock->TestMethodWithAnArgument(5);
+}
+
+BENCH(BenchTinyMocks,BenchSignature)
+{
+	TinyMock::Method<int,void,void,void,void> method("TestMethodWithAnArgument",5);
+	yaffut::DoNotOptimize(method.Signature());
+}
@@ -13,6 +13,12 @@ TestMock::TestMock(const std::string& className)
 
 void TestMock::TestMethod()
 {
+	static const TinyMock::StubId stub("TestMethod", typeid(void));
+	if(IsStubbed(stub))
+	{
+		return Stubbed<void>(stub);
+	}
+
     TinyMock::Method<void,void,void,void,void> actual("TestMethod");
 	TinyMock::BaseMethod* expected = m_expectations.GetFirstExpectationFor(actual.Signature());
 	
@@ -38,10 +44,16 @@ void TestMock::TestMethodWithAnArgument(int arg)
 
 int TestMock::TestMethodWithReturnValue()
 {
+	static const TinyMock::StubId stub("TestMethodWithReturnValue", typeid(int));
+	if(IsStubbed(stub))
+	{
+		return Stubbed<int>(stub);
+	}
+
 	TinyMock::Method<void,void,void,void,int> actual("TestMethodWithReturnValue",0);
 	TinyMock::BaseMethod* expected = m_expectations.GetFirstExpectationFor(actual.Signature());
 	
-	int ret = ((TinyMock::Method<void,void,void,void,int>*)expected)->m_r ;
+	int ret = expected ? ((TinyMock::Method<void,void,void,void,int>*)expected)->m_r : 0 ;
 
 	Handle(expected,(TinyMock::BaseMethod*)&actual);
 
@@ -0,0 +1,207 @@
+#include <iostream>
+using namespace std;
+#include <chrono>
+#include <stdexcept>
+#include <vector>
+
+#include "yaffut.h"
+#include "TinyMockAsync.h"
+using namespace TinyMock;
+
+#include "ConcreteNotifier.h"
+
+class ReaderMock : public StaticMock<ReaderMock>
+{
+public:
+	ReaderMock(const std::string& className)
+		: StaticMock<ReaderMock>(className), read(*this, "Read"), executor(NULL)
+	{
+	}
+	std::future<int> Read(int block)
+	{
+		return executor->Deliver(read(block));
+	}
+
+	StaticMethod<ReaderMock, int(int)> read ;
+	DeterministicExecutor* executor ;
+};
+
+static bool IsReady(std::future<int>& result)
+{
+	return result.wait_for(std::chrono::seconds(0)) == std::future_status::ready ;
+}
+
+struct TestAsync
+{
+    TestAsync()
+    {
+    }
+
+    ~TestAsync()
+    {
+    }
+};
+
+TEST(TestAsync,TestResultsArriveWhenTheExecutorRuns)
+{
+	MockRepository<ConcreteNotifier> mockRepository ;
+	ReaderMock* reader = mockRepository.CreateMock<ReaderMock,ConcreteNotifier>("Reader");
+	DeterministicExecutor executor ;
+	reader->executor = &executor ;
+
+	const int calls = 2000 ;
+	for(int i = 0; i < calls; ++i)
+	{
+		reader->read.Expect(i).Returns(2 * i);
+	}
+	std::vector<std::future<int> > results ;
+	for(int i = 0; i < calls; ++i)
+	{
+		results.push_back(reader->Read(i));
+	}
+	EQUAL(size_t(calls), executor.Pending());
+	CHECK(!IsReady(results[0]));
+
+	EQUAL(size_t(calls), executor.RunUntilIdle());
+
+	for(int i = 0; i < calls; ++i)
+	{
+		EQUAL(2 * i, results[i].get());
+	}
+	CHECK(mockRepository.verifyAll());
+}
+
+TEST(TestAsync,TestCompletingCallsOutOfOrder)
+{
+	MockRepository<ConcreteNotifier> mockRepository ;
+	ReaderMock* reader = mockRepository.CreateMock<ReaderMock,ConcreteNotifier>("Reader");
+	DeterministicExecutor executor ;
+	reader->executor = &executor ;
+
+	reader->read.Expect(1).Returns(10);
+	reader->read.Expect(2).Returns(20);
+	std::future<int> first = reader->Read(1);
+	std::future<int> second = reader->Read(2);
+
+	executor.RunAt(1);
+	CHECK(!IsReady(first));
+	EQUAL(20, second.get());
+
+	executor.RunOne();
+	EQUAL(10, first.get());
+	CHECK(mockRepository.verifyAll());
+}
+
+TEST(TestAsync,TestRunningATaskThatIsNotPending)
+{
+	DeterministicExecutor executor ;
+	executor.Post([]() {});
+	ASSERT_THROW(executor.RunAt(1), std::out_of_range);
+	EQUAL(1u, executor.Pending());
+}
+
+TEST(TestAsync,TestShuffledCompletionOrderIsReproducible)
+{
+	std::vector<int> orders[2];
+	for(int run = 0; run < 2; ++run)
+	{
+		DeterministicExecutor executor ;
+		executor.Shuffle(42);
+		for(int i = 0; i < 100; ++i)
+		{
+			std::vector<int>* order = &orders[run];
+			executor.Post([order, i]() { order->push_back(i); });
+		}
+		executor.RunUntilIdle();
+	}
+	EQUAL(100u, orders[0].size());
+	CHECK(orders[0] == orders[1]);
+
+	std::vector<int> posted ;
+	for(int i = 0; i < 100; ++i)
+	{
+		posted.push_back(i);
+	}
+	CHECK(orders[0] != posted);
+}
+
+TEST(TestAsync,TestDeliveringAFailure)
+{
+	DeterministicExecutor executor ;
+	std::future<int> result = executor.Fail<int>(std::make_exception_ptr(std::runtime_error("disk gone")));
+	executor.RunUntilIdle();
+	try
+	{
+		result.get();
+		FAIL("no exception delivered");
+	}
+	catch(const std::runtime_error& e)
+	{
+		EQUAL(std::string("disk gone"), e.what());
+	}
+}
+
+#if defined(__cpp_impl_coroutine)
+// A coroutine that starts right away and is owned by the executor once it
+// suspends.
+struct Detached
+{
+	struct promise_type
+	{
+		Detached get_return_object() { return Detached(); }
+		std::suspend_never initial_suspend() { return std::suspend_never(); }
+		std::suspend_never final_suspend() noexcept { return std::suspend_never(); }
+		void return_void() {}
+		void unhandled_exception() { std::terminate(); }
+	};
+};
+
+static Detached AddTwice(DeterministicExecutor& executor, int value, int& sum)
+{
+	sum += co_await executor.Await(value);
+	sum += co_await executor.Await(value);
+}
+
+TEST(TestAsync,TestCoroutinesResumeOnTheExecutor)
+{
+	DeterministicExecutor executor ;
+	int sum = 0 ;
+	AddTwice(executor, 3, sum);
+	AddTwice(executor, 4, sum);
+	EQUAL(0, sum);
+
+	EQUAL(4u, executor.RunUntilIdle());
+	EQUAL(14, sum);
+}
+
+// not default-constructible
+struct Block
+{
+	explicit Block(int number) : number(number) {}
+	int number ;
+};
+
+static Detached FlushThenRead(DeterministicExecutor& executor, std::string& log)
+{
+	co_await executor.Await();
+	log += "flushed " ;
+	try
+	{
+		co_await executor.AwaitFailure<Block>(std::make_exception_ptr(std::runtime_error("disk gone")));
+	}
+	catch(const std::runtime_error& e)
+	{
+		log += e.what();
+	}
+	log += " " + std::to_string((co_await executor.Await(Block(7))).number);
+}
+
+TEST(TestAsync,TestAwaitingNoValueAndFailuresOfAnyType)
+{
+	DeterministicExecutor executor ;
+	std::string log ;
+	FlushThenRead(executor, log);
+	EQUAL(3u, executor.RunUntilIdle());
+	EQUAL("flushed disk gone 7", log);
+}
+#endif
@@ -0,0 +1,157 @@
+#include <iostream>
+using namespace std;
+
+#include "yaffut.h"
+#include "TinyMockFuzz.h"
+using namespace TinyMock;
+
+#include "ConcreteNotifier.h"
+#include "TestMock.h"
+
+class Accumulator
+{
+public:
+	Accumulator(Test* dependency) : sum(0), failures(0), m_dependency(dependency) {}
+	void Poll(int times)
+	{
+		for(int i = 0; i < times; ++i)
+		{
+			try
+			{
+				sum += m_dependency->TestMethodWithReturnValue();
+			}
+			catch(const InjectedFailure&)
+			{
+				++failures ;
+			}
+		}
+	}
+	int sum ;
+	int failures ;
+private:
+	Test* m_dependency ;
+};
+
+class AccumulatorFixture : public FuzzFixture
+{
+public:
+	AccumulatorFixture()
+	{
+		++constructed ;
+		dependency = repository.CreateMock<TestMock,ConcreteNotifier>("TestMock");
+		Driver().AddChannel(dependency, TinyMock::Method<void,void,void,void,int>("TestMethodWithReturnValue",0), 16);
+	}
+	void Run()
+	{
+		Accumulator accumulator(dependency);
+		accumulator.Poll(1);
+		lastSum = accumulator.sum ;
+	}
+	MockRepository<ConcreteNotifier> repository ;
+	TestMock* dependency ;
+	static int constructed ;
+	static int lastSum ;
+};
+int AccumulatorFixture::constructed = 0 ;
+int AccumulatorFixture::lastSum = 0 ;
+
+struct TestFuzzDriver
+{
+    TestFuzzDriver()
+    {        
+    }
+	
+    ~TestFuzzDriver()
+    {        
+    }
+};
+
+TEST(TestFuzzDriver,TestDecodingReturnValuesDelaysAndFailures)
+{
+	MockRepository<ConcreteNotifier> mockRepository ;
+	TestMock* testMock = mockRepository.CreateMock<TestMock,ConcreteNotifier>("TestMock");
+
+	FuzzDriver driver ;
+	driver.AddChannel(testMock, TinyMock::Method<void,void,void,void,int>("TestMethodWithReturnValue",0), 8);
+
+	const uint8_t input[] = {
+		0, FuzzResponse::Return, 5, 0, 0, 0,
+		0, FuzzResponse::Delay, 10, 0, 7, 0, 0, 0,
+		0, FuzzResponse::Fail, 0, 0, 0, 0 };
+	driver.Load(input, sizeof(input));
+
+	EQUAL(3u, mockRepository.OutstandingExpectations());
+
+	Accumulator accumulator(testMock);
+	accumulator.Poll(3);
+
+	EQUAL(12, accumulator.sum);
+	EQUAL(1, accumulator.failures);
+	EQUAL(10u, driver.Delayed());
+	EQUAL(1u, driver.Failures());
+	CHECK(mockRepository.verifyAll());
+}
+
+TEST(TestFuzzDriver,TestPooledExpectationsAreRecycledBetweenInputs)
+{
+	MockRepository<ConcreteNotifier> mockRepository ;
+	TestMock* testMock = mockRepository.CreateMock<TestMock,ConcreteNotifier>("TestMock");
+
+	FuzzDriver driver ;
+	FuzzChannel<TinyMock::Method<void,void,void,void,int> >& channel =
+		driver.AddChannel(testMock, TinyMock::Method<void,void,void,void,int>("TestMethodWithReturnValue",0), 4);
+
+	const uint8_t input[] = {
+		0, FuzzResponse::Return, 1, 0, 0, 0,
+		0, FuzzResponse::Return, 2, 0, 0, 0,
+		0, FuzzResponse::Fail, 3, 0, 0, 0 };
+
+	for(int i = 0; i < 1000; ++i)
+	{
+		driver.Load(input, sizeof(input));
+		EQUAL(1u, channel.Available());
+
+		Accumulator accumulator(testMock);
+		accumulator.Poll(i % 4);
+	}
+
+	driver.Load(input, sizeof(input));
+	Accumulator accumulator(testMock);
+	accumulator.Poll(3);
+
+	EQUAL(4u, channel.Available());
+	CHECK(mockRepository.verifyAll());
+}
+
+TEST(TestFuzzDriver,TestLoadingAnInputKeepsTheOtherExpectationsOfTheMock)
+{
+	MockRepository<ConcreteNotifier> mockRepository ;
+	TestMock* testMock = mockRepository.CreateMock<TestMock,ConcreteNotifier>("TestMock");
+	testMock->RegisterExpectation(new TinyMock::Method<int,void,void,void,void>("TestMethodWithAnArgument",7));
+
+	FuzzDriver driver ;
+	driver.AddChannel(testMock, TinyMock::Method<void,void,void,void,int>("TestMethodWithReturnValue",0), 4);
+
+	const uint8_t input[] = { 0, FuzzResponse::Return, 1, 0, 0, 0 };
+	driver.Load(input, sizeof(input));
+	driver.Load(input, sizeof(input));
+	EQUAL(2u, mockRepository.OutstandingExpectations());
+
+	testMock->TestMethodWithAnArgument(7);
+	EQUAL(1, testMock->TestMethodWithReturnValue());
+	CHECK(mockRepository.verifyAll());
+}
+
+TEST(TestFuzzDriver,TestTheFuzzTargetKeepsItsFixtureBetweenInputs)
+{
+	const uint8_t first[] = { 0, FuzzResponse::Return, 42, 0, 0, 0 };
+	const uint8_t second[] = { 0, FuzzResponse::Return, 43, 0, 0, 0 };
+
+	RunFuzzInput<AccumulatorFixture>(first, sizeof(first));
+	EQUAL(42, AccumulatorFixture::lastSum);
+
+	RunFuzzInput<AccumulatorFixture>(second, sizeof(second));
+	EQUAL(43, AccumulatorFixture::lastSum);
+
+	EQUAL(1, AccumulatorFixture::constructed);
+}
@@ -0,0 +1,90 @@
+#include <iostream>
+using namespace std;
+#include <sstream>
+
+#include "yaffut.h"
+#include "TinyMock.h"
+using namespace TinyMock;
+
+#include "ConcreteNotifier.h"
+#include "TestMock.h"
+
+typedef TinyMock::Method<int,void,void,void,void> WithAnArgument ;
+typedef TinyMock::Method<void,void,void,void,int> WithReturnValue ;
+
+static void ThreeTimes(unsigned long long call, WithAnArgument& expected)
+{
+	expected.m_p1 = static_cast<int>(3 * call);
+}
+
+struct TestGenerator
+{
+    TestGenerator()
+    {
+    }
+
+    ~TestGenerator()
+    {
+    }
+};
+
+TEST(TestGenerator,TestLongRunInConstantMemory)
+{
+	MockRepository<ConcreteNotifier> mockRepository ;
+	TestMock* testMock = mockRepository.CreateMock<TestMock,ConcreteNotifier>("TestMock");
+
+	const int calls = 100000 ;
+	ExpectationGenerator<WithAnArgument> generator(WithAnArgument("TestMethodWithAnArgument",0), calls, &ThreeTimes);
+	testMock->AddExpectationSource(&generator);
+	EQUAL(size_t(calls), mockRepository.OutstandingExpectations());
+
+	for(int i = 0; i < calls; ++i)
+	{
+		testMock->TestMethodWithAnArgument(3 * i);
+	}
+
+	EQUAL(1u, generator.Allocated());
+	EQUAL(0u, mockRepository.OutstandingExpectations());
+	CHECK(mockRepository.verifyAll());
+}
+
+TEST(TestGenerator,TestGeneratedAndRegisteredExpectationsTogether)
+{
+	MockRepository<ConcreteNotifier> mockRepository ;
+	TestMock* testMock = mockRepository.CreateMock<TestMock,ConcreteNotifier>("TestMock");
+
+	ExpectationGenerator<WithReturnValue> generator(WithReturnValue("TestMethodWithReturnValue",0), 3,
+		[](unsigned long long call, WithReturnValue& expected) { expected.m_r = static_cast<int>(call * call); });
+	testMock->AddExpectationSource(&generator);
+	testMock->RegisterExpectation(new WithReturnValue("TestMethodWithReturnValue",-1));
+
+	EQUAL(-1, testMock->TestMethodWithReturnValue());
+	EQUAL(0, testMock->TestMethodWithReturnValue());
+	EQUAL(1, testMock->TestMethodWithReturnValue());
+	EQUAL(4, testMock->TestMethodWithReturnValue());
+	CHECK(mockRepository.verifyAll());
+}
+
+TEST(TestGenerator,TestLeftoverCallsAreReported)
+{
+	MockRepository<ConcreteNotifier> mockRepository ;
+	mockRepository.CollectViolations();
+	TestMock* testMock = mockRepository.CreateMock<TestMock,ConcreteNotifier>("TestMock");
+
+	ExpectationGenerator<WithAnArgument> generator(WithAnArgument("TestMethodWithAnArgument",0), 10, &ThreeTimes);
+	testMock->AddExpectationSource(&generator);
+	testMock->TestMethodWithAnArgument(0);
+	testMock->TestMethodWithAnArgument(4);
+
+	EQUAL(1u, mockRepository.Violations().Size());
+	EQUAL("TestMethodWithAnArgument(3)", mockRepository.Violations()[0].expected);
+
+	std::stringstream pending ;
+	mockRepository.PrintPendingExpectations(pending);
+	EQUAL("TestMock::TestMethodWithAnArgument(6) is call 3 of 10 expected\n", pending.str());
+
+	MockPrinter::Silent(true);
+	CHECK(!mockRepository.verifyAll());
+	MockPrinter::Silent(false);
+	EQUAL(0u, mockRepository.OutstandingExpectations());
+}
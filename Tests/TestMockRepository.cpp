@@ -1,5 +1,9 @@
 #include <iostream>
 using namespace std;
+#include <sstream>
+#include <vector>
+#include <thread>
+#include <atomic>
 
 #include "yaffut.h"
 #include "TinyMock.h"
@@ -8,6 +12,14 @@ using namespace TinyMock;
 #include "ConcreteNotifier.h"
 #include "TestMock.h"
 
+static unsigned long long fakeNow = 0 ;
+static unsigned long long fakeStep = 1000 ;
+
+static unsigned long long FakeTime()
+{
+	return fakeNow += fakeStep ;
+}
+
 struct TestMockRepository
 {
     TestMockRepository()
@@ -76,3 +88,264 @@ TEST(TestMockRepository,TestCheckingIfAGivenExpectationIsNOTSatisfied)
 
 	CHECK(mockRepository.verifyAll());
 }
+
+TEST(TestMockRepository,TestPrintingPendingExpectationsOfLiveRepositories)
+{
+	MockRepository<> mockRepository ;
+
+	TestMock* testMock = mockRepository.CreateMock<TestMock,ConcreteNotifier>("TestMock");
+        testMock->RegisterExpectation(new TinyMock::Method<int,void,void,void,void>("TestMethodWithAnArgument",7));
+
+	std::stringstream out ;
+	LiveRepositories::PrintPendingExpectations(out);
+
+	CHECK(out.str().find("TestMock::TestMethodWithAnArgument(7)") != std::string::npos);
+
+	CHECK(!mockRepository.verifyAll());
+}
+
+TEST(TestMockRepository,TestTheHangReportIsASnapshot)
+{
+	MockRepository<> mockRepository ;
+	TestMock* testMock = mockRepository.CreateMock<TestMock,ConcreteNotifier>("TestMock");
+        testMock->RegisterExpectation(new TinyMock::Method<int,void,void,void,void>("TestMethodWithAnArgument",7));
+
+	// as a hung test would, this keeps changing a repository while it is reported
+	std::atomic<bool> hung(true);
+	std::thread busy([&hung]()
+	{
+		MockRepository<> busyRepository ;
+		TestMock* busyMock = busyRepository.CreateMock<TestMock,ConcreteNotifier>("BusyMock");
+		while(hung)
+		{
+			busyMock->RegisterExpectation(new TinyMock::Method<void,void,void,void,void>("TestMethod"));
+			busyMock->ClearExpectations();
+		}
+	});
+	std::stringstream out ;
+	yaffut::Factory::Instance().ReportHang(out);
+	hung = false ;
+	busy.join();
+
+	CHECK(out.str().find("TestMock::TestMethodWithAnArgument(7)") != std::string::npos);
+	CHECK(out.str().find("incomplete") == std::string::npos);
+
+	CHECK(!mockRepository.verifyAll());
+}
+
+TEST(TestMockRepository,TestCountingOutstandingExpectations)
+{
+	ConcreteNotifier failureNotifier ;
+
+	MockRepository<> mockRepository ;
+
+	TestMock* testMock_1 = mockRepository.CreateMock<TestMock,ConcreteNotifier>("TestMock_1");
+	TestMock* testMock_2 = mockRepository.CreateMock<TestMock,ConcreteNotifier>("TestMock_2");
+        testMock_1->RegisterExpectation(new TinyMock::Method<void,void,void,void,void>("TestMethod"));
+        testMock_1->RegisterExpectation(new TinyMock::Method<void,void,void,void,void>("TestMethod"));
+        testMock_2->RegisterExpectation(new TinyMock::Method<void,void,void,void,void>("TestMethod"));
+
+	EQUAL(3u, mockRepository.OutstandingExpectations());
+
+	testMock_1->TestMethod();
+
+	EQUAL(2u, mockRepository.OutstandingExpectations());
+
+	CHECK(!mockRepository.verify("TestMock_2"));
+
+	EQUAL(1u, mockRepository.OutstandingExpectations());
+
+	mockRepository.verifyAll(failureNotifier);
+
+	CHECK(failureNotifier.sendWasCalled);
+	EQUAL(0u, mockRepository.OutstandingExpectations());
+}
+
+TEST(TestMockRepository,TestVerifyingManyMocksAtManyCheckpoints)
+{
+	MockRepository<> mockRepository ;
+
+	std::vector<TestMock*> mocks ;
+	for(int i = 0; i < 1000; ++i)
+	{
+		std::stringstream name ;
+		name << "TestMock_" << i ;
+		mocks.push_back(mockRepository.CreateMock<TestMock,ConcreteNotifier>(name.str()));
+	}
+
+	for(int checkpoint = 0; checkpoint < 1000; ++checkpoint)
+	{
+		TestMock* testMock = mocks[checkpoint];
+		testMock->RegisterExpectation(new TinyMock::Method<int,void,void,void,void>("TestMethodWithAnArgument",checkpoint));
+		testMock->TestMethodWithAnArgument(checkpoint);
+
+		CHECK(mockRepository.verifyAll());
+	}
+}
+
+TEST(TestMockRepository,TestResettingClearsExpectationsIgnoresAndViolations)
+{
+	ConcreteNotifier failureNotifier ;
+
+	MockRepository<> mockRepository ;
+	mockRepository.CollectViolations();
+
+	TestMock* testMock = mockRepository.CreateMock<TestMock,ConcreteNotifier>("TestMock");
+        testMock->RegisterExpectation(new TinyMock::Method<int,void,void,void,void>("TestMethodWithAnArgument",1));
+	testMock->IgnoreAll("TestMethod");
+	testMock->TestMethodWithAnArgument(2);
+
+	mockRepository.Reset();
+
+	EQUAL(0u, mockRepository.OutstandingExpectations());
+	EQUAL(0u, mockRepository.Violations().Size());
+
+	testMock->TestMethod();
+
+	EQUAL(1u, mockRepository.Violations().Size());
+	CHECK(!mockRepository.verifyAll(failureNotifier));
+
+	for(int scenario = 0; scenario < 100; ++scenario)
+	{
+		testMock->RegisterExpectation(new TinyMock::Method<int,void,void,void,void>("TestMethodWithAnArgument",scenario));
+		testMock->TestMethodWithAnArgument(scenario);
+		CHECK(mockRepository.verifyAll());
+		mockRepository.Reset();
+	}
+}
+
+TEST(TestMockRepository,TestCreatingMocksAfterRecyclingReusesThemByType)
+{
+	MockRepository<> mockRepository ;
+
+	TestMock* first = mockRepository.CreateMock<TestMock,ConcreteNotifier>("First");
+        first->RegisterExpectation(new TinyMock::Method<void,void,void,void,void>("TestMethod"));
+
+	mockRepository.Recycle();
+
+	CHECK(mockRepository.verifyAll());
+	CHECK(!mockRepository.verify("First"));
+
+	TestMock* second = mockRepository.CreateMock<TestMock,ConcreteNotifier>("Second");
+	TestMock* third = mockRepository.CreateMock<TestMock,ConcreteNotifier>("Third");
+
+	CHECK(first == second);
+	CHECK(first != third);
+
+        second->RegisterExpectation(new TinyMock::Method<void,void,void,void,void>("TestMethod"));
+
+	std::stringstream out ;
+	mockRepository.PrintPendingExpectations(out);
+	EQUAL("Second::TestMethod()\n", out.str());
+
+	CHECK(!mockRepository.verify("Second"));
+}
+
+TEST(TestMockRepository,TestCallStatisticsOfEveryMethod)
+{
+	MockRepository<ConcreteNotifier> mockRepository ;
+	TestMock* testMock = mockRepository.CreateMock<TestMock,ConcreteNotifier>("TestMock");
+	mockRepository.RecordCallStatistics(&FakeTime);
+	testMock->IgnoreAll("TestMethod");
+	testMock->IgnoreAll("TestMethodWithAnArgument");
+
+	fakeStep = 1000 ;
+	for(int i = 0; i < 101; ++i)
+	{
+		testMock->TestMethod();
+	}
+	testMock->TestMethodWithAnArgument(1);
+
+	const CallStatistics* statistics = mockRepository.CallStatisticsOf("TestMock");
+	CHECK(statistics != NULL);
+	const MethodStatistics* testMethod = statistics->Find("TestMethod");
+	EQUAL(101u, testMethod->Calls());
+	EQUAL(100u, testMethod->Intervals());
+	CHECK(testMethod->Percentile(99) >= 1000 && testMethod->Percentile(99) < 1250);
+	CHECK(testMethod->Mean() == 1000.0);
+	CHECK(testMethod->Burstiness() < 0.2);
+	EQUAL(1u, statistics->Find("TestMethodWithAnArgument")->Calls());
+	CHECK(statistics->Find("TestMethodWithReturnValue") == NULL);
+
+	std::stringstream out ;
+	mockRepository.PrintCallStatistics(out);
+	CHECK(out.str().find("TestMock::TestMethod calls=101 mean=1000ns") != std::string::npos);
+
+	mockRepository.Reset();
+	EQUAL(0u, statistics->Find("TestMethod")->Calls());
+}
+
+TEST(TestMockRepository,TestBurstsShowInTheHistogram)
+{
+	CallStatistics statistics(&FakeTime);
+	for(int burst = 0; burst < 10; ++burst)
+	{
+		fakeStep = 100000 ;
+		statistics.Record("Write");
+		fakeStep = 10 ;
+		for(int i = 0; i < 9; ++i)
+		{
+			statistics.Record("Write");
+		}
+	}
+
+	const MethodStatistics* write = statistics.Find("Write");
+	CHECK(write->Percentile(50) <= 12);
+	CHECK(write->Percentile(99) >= 100000);
+	CHECK(write->Burstiness() > 1.0);
+}
+
+TEST(TestMockRepository,TestATimeSourceStartingAtZero)
+{
+	MethodStatistics statistics ;
+	statistics.Record(0);
+	statistics.Record(10);
+	statistics.Record(20);
+
+	EQUAL(2u, statistics.Intervals());
+	CHECK(statistics.Mean() == 10.0);
+	EQUAL(MethodStatistics::UpperBound(MethodStatistics::BucketOf(10)), statistics.Percentile(1));
+}
+
+TEST(TestMockRepository,TestHistogramBucketsCoverTheirValues)
+{
+	bool covered = true ;
+	for(int shift = 0; shift < 64; ++shift)
+	{
+		const unsigned long long values[] = { 1ULL << shift, (1ULL << shift) + (1ULL << shift) / 3, (1ULL << shift) * 2 - 1 };
+		for(int v = 0; v < 3; ++v)
+		{
+			const size_t bucket = MethodStatistics::BucketOf(values[v]);
+			covered = covered && bucket < MethodStatistics::Buckets ;
+			covered = covered && MethodStatistics::LowerBound(bucket) <= values[v] && values[v] <= MethodStatistics::UpperBound(bucket);
+		}
+	}
+	CHECK(covered);
+}
+
+TEST(TestMockRepository,TestRecordingCallsFromManyThreads)
+{
+	CallStatistics statistics ;
+	const char* names[] = { "Open", "Read", "Write", "Close" };
+	std::vector<std::thread> threads ;
+	for(int t = 0; t < 4; ++t)
+	{
+		threads.push_back(std::thread([&statistics, &names]()
+		{
+			for(int i = 0; i < 10000; ++i)
+			{
+				statistics.Record(names[i % 4]);
+			}
+		}));
+	}
+	for(size_t t = 0; t < threads.size(); ++t)
+	{
+		threads[t].join();
+	}
+
+	EQUAL(4u, statistics.Methods().size());
+	for(int n = 0; n < 4; ++n)
+	{
+		EQUAL(10000u, statistics.Find(names[n])->Calls());
+	}
+}
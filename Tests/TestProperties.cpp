@@ -0,0 +1,156 @@
+#include <iostream>
+using namespace std;
+#include <string>
+#include <vector>
+
+#include "yaffut.h"
+#include "TinyMock.h"
+using namespace TinyMock;
+
+#include "ConcreteNotifier.h"
+#include "TestMock.h"
+
+class PropertyFailureNotifier : public TinyMock::TinyNotifier
+{
+public:	
+	PropertyFailureNotifier() {}
+	void Send(bool status=true)
+	{
+		FAIL("");
+	}	
+};
+
+struct TestProperties
+{
+    TestProperties()
+    {        
+    }
+	
+    ~TestProperties()
+    {        
+    }
+};
+
+struct TestPropertiesWithMocks
+{
+    TestPropertiesWithMocks()
+    {        
+		++constructed ;
+		testMock = mockRepository.CreateMock<TestMock,PropertyFailureNotifier>("TestMock");
+    }
+	
+    ~TestPropertiesWithMocks()
+    {        
+    }
+
+	MockRepository<PropertyFailureNotifier> mockRepository ;
+	TestMock* testMock ;
+	static int constructed ;
+};
+int TestPropertiesWithMocks::constructed = 0 ;
+
+struct FailsFromTen
+{
+	void Check(int value)
+	{
+		CHECK(value < 10);
+	}
+};
+
+struct FailsFromTenWithMocks
+{
+	FailsFromTenWithMocks()
+	{
+		testMock = mockRepository.CreateMock<TestMock,PropertyFailureNotifier>("TestMock");
+	}
+	void Reset()
+	{
+		mockRepository.Reset();
+	}
+	void Check(int value)
+	{
+		testMock->RegisterExpectation(new TinyMock::Method<int,void,void,void,void>("TestMethodWithAnArgument",value));
+		CHECK(value < 10);
+		testMock->TestMethodWithAnArgument(value);
+		CHECK(mockRepository.verifyAll());
+	}
+	MockRepository<PropertyFailureNotifier> mockRepository ;
+	TestMock* testMock ;
+};
+
+struct RecordsInputs
+{
+	void Check(int value, std::string text)
+	{
+		values.push_back(value);
+		texts.push_back(text);
+	}
+	std::vector<int> values ;
+	std::vector<std::string> texts ;
+};
+
+PROPERTY(TestProperties,AdditionIsCommutative,yaffut::gen::Int(-1000,1000),yaffut::gen::Int(-1000,1000))(int a, int b)
+{
+	EQUAL(a + b, b + a);
+}
+
+PROPERTY(TestProperties,ReversingAVectorTwiceGivesTheVectorBack,yaffut::gen::Vector(yaffut::gen::Int(0,9),20))(std::vector<int> values)
+{
+	std::vector<int> reversed(values.rbegin(), values.rend());
+	CHECK(std::vector<int>(reversed.rbegin(), reversed.rend()) == values);
+}
+
+PROPERTY_N(TestPropertiesWithMocks,TheMockRepositoryIsReusedForAllInputs,500,yaffut::gen::Int(-100,100))(int value)
+{
+	EQUAL(1, constructed);
+
+	testMock->RegisterExpectation(new TinyMock::Method<int,void,void,void,void>("TestMethodWithAnArgument",value));
+
+	testMock->TestMethodWithAnArgument(value);
+
+	CHECK(mockRepository.verifyAll());
+}
+
+TEST(TestProperties,TestAFalsifiedPropertyReportsTheSeedAndTheShrunkInput)
+{
+	FailsFromTen property ;
+	try
+	{
+		yaffut::CheckProperty(property, &FailsFromTen::Check, 200, 1234, "FailsFromTen", yaffut::gen::Int(0,1000));
+	}
+	catch(const yaffut::failure& e)
+	{
+		const std::string report(e.what());
+		CHECK(report.find("--seed 1234") != std::string::npos);
+		CHECK(report.find("shrunk: (10)") != std::string::npos);
+		return ;
+	}
+	FAIL("property was not falsified");
+}
+
+TEST(TestProperties,TestAFailingInputLeavesNoExpectationsToTheNext)
+{
+	FailsFromTenWithMocks property ;
+	try
+	{
+		yaffut::CheckProperty(property, &FailsFromTenWithMocks::Check, 200, 1234, "FailsFromTenWithMocks", yaffut::gen::Int(0,1000));
+	}
+	catch(const yaffut::failure& e)
+	{
+		CHECK(std::string(e.what()).find("shrunk: (10)") != std::string::npos);
+		return ;
+	}
+	FAIL("property was not falsified");
+}
+
+TEST(TestProperties,TestTheSameSeedGeneratesTheSameInputs)
+{
+	RecordsInputs first ;
+	RecordsInputs second ;
+	yaffut::CheckProperty(first, &RecordsInputs::Check, 100, 99, "RecordsInputs", yaffut::gen::Int(-5,5), yaffut::gen::String(8));
+	yaffut::CheckProperty(second, &RecordsInputs::Check, 100, 99, "RecordsInputs", yaffut::gen::Int(-5,5), yaffut::gen::String(8));
+
+	EQUAL(100u, first.values.size());
+	CHECK(first.values == second.values);
+	CHECK(first.texts == second.texts);
+}
@@ -0,0 +1,199 @@
+#include <iostream>
+using namespace std;
+#include <stdio.h>
+#include <string>
+
+#include "yaffut.h"
+#include "TinyMockScript.h"
+using namespace TinyMock;
+
+#include "ConcreteNotifier.h"
+#include "TestMock.h"
+
+enum ScriptedMethod { ScriptedArgument, ScriptedReturnValue };
+
+typedef TinyMock::Method<int,void,void,void,void> WithAnArgument ;
+typedef TinyMock::Method<void,void,void,void,int> WithReturnValue ;
+
+static void Follow(MappedScript& script)
+{
+	script.On<int>(ScriptedArgument, WithAnArgument("TestMethodWithAnArgument",0), [](int arg)
+	{
+		return new WithAnArgument("TestMethodWithAnArgument",arg);
+	});
+	script.On<int>(ScriptedReturnValue, WithReturnValue("TestMethodWithReturnValue",0), [](int result)
+	{
+		return new WithReturnValue("TestMethodWithReturnValue",result);
+	});
+}
+
+struct TestScript
+{
+    TestScript() : path("TestScript.script")
+    {
+    }
+
+    ~TestScript()
+    {
+		remove(path.c_str());
+    }
+
+	std::string path ;
+};
+
+TEST(TestScript,TestCallsFollowTheScript)
+{
+	const int calls = 100000 ;
+	{
+		TraceWriter script(path);
+		for(int i = 0; i < calls; ++i)
+		{
+			script.Record(ScriptedArgument, i);
+			script.Record(ScriptedReturnValue, 2 * i);
+		}
+	}
+
+	MockRepository<ConcreteNotifier> mockRepository ;
+	TestMock* testMock = mockRepository.CreateMock<TestMock,ConcreteNotifier>("TestMock");
+	MappedScript script(path);
+	Follow(script);
+	testMock->AddExpectationSource(&script);
+	EQUAL(size_t(2 * calls), mockRepository.OutstandingExpectations());
+
+	bool followed = true ;
+	for(int i = 0; i < calls; ++i)
+	{
+		testMock->TestMethodWithAnArgument(i);
+		followed = followed && testMock->TestMethodWithReturnValue() == 2 * i ;
+	}
+	CHECK(followed);
+	EQUAL(0u, script.Pending());
+	CHECK(mockRepository.verifyAll());
+}
+
+TEST(TestScript,TestRecordsOfOtherMethodsAreMadeOnTheWay)
+{
+	{
+		TraceWriter script(path);
+		script.Record(ScriptedArgument, 1);
+		script.Record(ScriptedReturnValue, 10);
+		script.Record(ScriptedArgument, 2);
+		script.Record(ScriptedReturnValue, 20);
+		script.Record(ScriptedArgument, 3);
+	}
+
+	MockRepository<ConcreteNotifier> mockRepository ;
+	TestMock* testMock = mockRepository.CreateMock<TestMock,ConcreteNotifier>("TestMock");
+	MappedScript script(path);
+	Follow(script);
+	testMock->AddExpectationSource(&script);
+
+	EQUAL(10, testMock->TestMethodWithReturnValue());
+	EQUAL(20, testMock->TestMethodWithReturnValue());
+	EQUAL(1u, script.Pending());
+	EQUAL(3u, mockRepository.OutstandingExpectations());
+
+	testMock->TestMethodWithAnArgument(1);
+	testMock->TestMethodWithAnArgument(2);
+	testMock->TestMethodWithAnArgument(3);
+	CHECK(mockRepository.verifyAll());
+}
+
+TEST(TestScript,TestUnreadRecordsFailVerification)
+{
+	{
+		TraceWriter script(path);
+		script.Record(ScriptedArgument, 1);
+		script.Record(ScriptedArgument, 2);
+		script.Record(ScriptedArgument, 3);
+	}
+
+	MockRepository<ConcreteNotifier> mockRepository ;
+	TestMock* testMock = mockRepository.CreateMock<TestMock,ConcreteNotifier>("TestMock");
+	MappedScript script(path);
+	Follow(script);
+	testMock->AddExpectationSource(&script);
+	testMock->TestMethodWithAnArgument(1);
+
+	std::stringstream pending ;
+	mockRepository.PrintPendingExpectations(pending);
+	EQUAL("TestMock::2 calls not yet read from TestScript.script\n", pending.str());
+
+	MockPrinter::Silent(true);
+	CHECK(!mockRepository.verifyAll());
+	MockPrinter::Silent(false);
+	EQUAL(0u, mockRepository.OutstandingExpectations());
+}
+
+TEST(TestScript,TestCallsOfUnscriptedMethodsDoNotReadTheScript)
+{
+	const int calls = 100000 ;
+	{
+		TraceWriter script(path);
+		for(int i = 0; i < calls; ++i)
+		{
+			script.Record(ScriptedArgument, i);
+		}
+	}
+
+	MockRepository<ConcreteNotifier> mockRepository ;
+	mockRepository.CollectViolations();
+	TestMock* testMock = mockRepository.CreateMock<TestMock,ConcreteNotifier>("TestMock");
+	MappedScript script(path);
+	Follow(script);
+	testMock->AddExpectationSource(&script);
+	testMock->IgnoreAll("TestMethod");
+
+	for(int i = 0; i < 1000; ++i)
+	{
+		testMock->TestMethod();
+	}
+	EQUAL(size_t(calls), script.Pending());
+	EQUAL(0u, mockRepository.Violations().Size());
+}
+
+TEST(TestScript,TestACallReadsAheadNoFurtherThanTheWindow)
+{
+	{
+		TraceWriter script(path);
+		for(int i = 0; i < 1000; ++i)
+		{
+			script.Record(ScriptedArgument, i);
+		}
+		script.Record(ScriptedReturnValue, 7);
+	}
+
+	MockRepository<ConcreteNotifier> mockRepository ;
+	mockRepository.CollectViolations();
+	TestMock* testMock = mockRepository.CreateMock<TestMock,ConcreteNotifier>("TestMock");
+	MappedScript script(path);
+	Follow(script);
+	script.Window(100);
+	testMock->AddExpectationSource(&script);
+
+	EQUAL(0, testMock->TestMethodWithReturnValue());
+	EQUAL(901u, script.Pending());
+	EQUAL(0, testMock->TestMethodWithReturnValue());
+	EQUAL(901u, script.Pending());
+	EQUAL(2u, mockRepository.Violations().Size());
+	CHECK(mockRepository.Violations()[0].kind == Violation::NotExpected);
+
+	testMock->TestMethodWithAnArgument(0);
+	EQUAL(0, testMock->TestMethodWithReturnValue());
+	EQUAL(900u, script.Pending());
+}
+
+TEST(TestScript,TestFileThatIsNotAScript)
+{
+	FILE* file = fopen(path.c_str(), "wb");
+	fputs("not a script at all", file);
+	fclose(file);
+	try
+	{
+		MappedScript script(path);
+		FAIL("not a script accepted");
+	}
+	catch(const TraceError&)
+	{
+	}
+}
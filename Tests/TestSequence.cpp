@@ -0,0 +1,139 @@
+#include <iostream>
+using namespace std;
+#include <thread>
+
+#include "yaffut.h"
+#include "TinyMock.h"
+using namespace TinyMock;
+
+#include "ConcreteNotifier.h"
+#include "TestMock.h"
+
+class SequencedStaticMock : public StaticMock<SequencedStaticMock>
+{
+public:
+	SequencedStaticMock(const std::string& className)
+		: StaticMock<SequencedStaticMock>(className), testMethodWithAnArgument(*this, "TestMethodWithAnArgument")
+	{
+	}
+	void TestMethodWithAnArgument(int arg) { testMethodWithAnArgument(arg); }
+
+	StaticMethod<SequencedStaticMock, void(int)> testMethodWithAnArgument ;
+};
+
+struct TestSequence
+{
+    TestSequence()
+    {
+    }
+
+    ~TestSequence()
+    {
+    }
+};
+
+TEST(TestSequence,TestCallsInOrderAcrossMocks)
+{
+	MockRepository<ConcreteNotifier> mockRepository ;
+	mockRepository.CollectViolations();
+	TestMock* first = mockRepository.CreateMock<TestMock,ConcreteNotifier>("First");
+	TestMock* second = mockRepository.CreateMock<TestMock,ConcreteNotifier>("Second");
+
+	Sequence sequence ;
+	first->RegisterExpectation(sequence, new TinyMock::Method<void,void,void,void,void>("TestMethod"));
+	second->RegisterExpectation(sequence, new TinyMock::Method<int,void,void,void,void>("TestMethodWithAnArgument",1));
+	first->RegisterExpectation(sequence, new TinyMock::Method<int,void,void,void,void>("TestMethodWithAnArgument",2));
+
+	first->TestMethod();
+	second->TestMethodWithAnArgument(1);
+	first->TestMethodWithAnArgument(2);
+
+	EQUAL(3u, sequence.Position());
+	CHECK(mockRepository.Violations().IsEmpty());
+	CHECK(mockRepository.verifyAll());
+}
+
+TEST(TestSequence,TestCallOutOfOrderIsReportedWithTheCallItSkipped)
+{
+	MockRepository<ConcreteNotifier> mockRepository ;
+	mockRepository.CollectViolations();
+	TestMock* first = mockRepository.CreateMock<TestMock,ConcreteNotifier>("First");
+	TestMock* second = mockRepository.CreateMock<TestMock,ConcreteNotifier>("Second");
+
+	Sequence sequence ;
+	first->RegisterExpectation(sequence, new TinyMock::Method<void,void,void,void,void>("TestMethod"));
+	second->RegisterExpectation(sequence, new TinyMock::Method<void,void,void,void,void>("TestMethod"));
+
+	second->TestMethod();
+	first->TestMethod();
+
+	EQUAL(1u, mockRepository.Violations().Size());
+	EQUAL(Violation::OutOfOrder, mockRepository.Violations()[0].kind);
+	EQUAL("First::TestMethod()", mockRepository.Violations()[0].expected);
+	EQUAL("Second::TestMethod()", mockRepository.Violations()[0].actual);
+
+	MockPrinter::Silent(true);
+	CHECK(!mockRepository.verifyAll());
+	MockPrinter::Silent(false);
+}
+
+TEST(TestSequence,TestStaticMocksCalledFromAnotherThread)
+{
+	MockRepository<ConcreteNotifier> mockRepository ;
+	mockRepository.CollectViolations();
+	SequencedStaticMock* opener = mockRepository.CreateMock<SequencedStaticMock,ConcreteNotifier>("Opener");
+	SequencedStaticMock* writer = mockRepository.CreateMock<SequencedStaticMock,ConcreteNotifier>("Writer");
+
+	const int calls = 1000 ;
+	Sequence sequence ;
+	for(int i = 0; i < calls; ++i)
+	{
+		opener->testMethodWithAnArgument.Expect(sequence, i);
+	}
+	for(int i = 0; i < calls; ++i)
+	{
+		writer->testMethodWithAnArgument.Expect(sequence, i);
+	}
+
+	for(int i = 0; i < calls; ++i)
+	{
+		opener->TestMethodWithAnArgument(i);
+	}
+	std::thread worker([writer]()
+	{
+		for(int i = 0; i < calls; ++i)
+		{
+			writer->TestMethodWithAnArgument(i);
+		}
+	});
+	worker.join();
+
+	EQUAL(size_t(2 * calls), sequence.Position());
+	CHECK(mockRepository.Violations().IsEmpty());
+	CHECK(mockRepository.verifyAll());
+}
+
+TEST(TestSequence,TestStaticMockCallOutOfOrder)
+{
+	MockRepository<ConcreteNotifier> mockRepository ;
+	mockRepository.CollectViolations();
+	SequencedStaticMock* opener = mockRepository.CreateMock<SequencedStaticMock,ConcreteNotifier>("Opener");
+	SequencedStaticMock* writer = mockRepository.CreateMock<SequencedStaticMock,ConcreteNotifier>("Writer");
+
+	Sequence sequence ;
+	opener->testMethodWithAnArgument.Expect(sequence, 1);
+	writer->testMethodWithAnArgument.Expect(sequence, 2);
+	opener->testMethodWithAnArgument.Expect(sequence, 3);
+
+	opener->TestMethodWithAnArgument(1);
+	opener->TestMethodWithAnArgument(3);
+	writer->TestMethodWithAnArgument(2);
+
+	EQUAL(1u, mockRepository.Violations().Size());
+	EQUAL("Writer::TestMethodWithAnArgument(2)", mockRepository.Violations()[0].expected);
+	EQUAL("Opener::TestMethodWithAnArgument(3)", mockRepository.Violations()[0].actual);
+
+	MockPrinter::Silent(true);
+	CHECK(!mockRepository.verifyAll());
+	MockPrinter::Silent(false);
+}
@@ -0,0 +1,212 @@
+#include <iostream>
+using namespace std;
+#include <sstream>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "yaffut.h"
+#include "TinyMockShared.h"
+using namespace TinyMock;
+
+#include "ConcreteNotifier.h"
+#include "TestMock.h"
+
+typedef TinyMock::Method<int,void,void,void,void> WithAnArgument ;
+typedef TinyMock::Method<void,void,void,void,int> WithReturnValue ;
+
+// Runs 'work' in 'workers' forked processes and waits for them; true if
+// they all exited with 0.
+template <typename Work>
+static bool InWorkers(int workers, Work work)
+{
+	std::vector<pid_t> pids ;
+	for(int w = 0; w < workers; ++w)
+	{
+		const pid_t pid = fork();
+		if(pid == 0)
+		{
+			_exit(work(w));
+		}
+		pids.push_back(pid);
+	}
+	bool succeeded = true ;
+	for(size_t p = 0; p < pids.size(); ++p)
+	{
+		int status = 0 ;
+		waitpid(pids[p], &status, 0);
+		succeeded = succeeded && WIFEXITED(status) && WEXITSTATUS(status) == 0 ;
+	}
+	return succeeded ;
+}
+
+struct TestShared
+{
+    TestShared()
+    {
+		testMock = mockRepository.CreateMock<TestMock,ConcreteNotifier>("TestMock");
+    }
+
+    ~TestShared()
+    {
+    }
+
+	SharedMockRepository<ConcreteNotifier> mockRepository ;
+	TestMock* testMock ;
+};
+
+TEST(TestShared,TestWorkersMeetTheExpectationsOfTheParent)
+{
+	SharedQueue<WithAnArgument>& calls = mockRepository.Share(testMock, WithAnArgument("TestMethodWithAnArgument",0), 4000);
+	for(int i = 0; i < 4000; ++i)
+	{
+		calls.Expect(WithAnArgument("TestMethodWithAnArgument",7));
+	}
+	EQUAL(4000u, mockRepository.OutstandingExpectations());
+
+	TestMock* mock = testMock ;
+	CHECK(InWorkers(4, [mock](int)
+	{
+		for(int i = 0; i < 1000; ++i)
+		{
+			mock->TestMethodWithAnArgument(7);
+		}
+		return 0 ;
+	}));
+
+	EQUAL(0u, calls.Pending());
+	EQUAL(0u, mockRepository.OutstandingExpectations());
+	CHECK(mockRepository.verifyAll());
+}
+
+TEST(TestShared,TestWorkersGetTheReturnValuesInOrder)
+{
+	SharedQueue<WithReturnValue>& results = mockRepository.Share(testMock, WithReturnValue("TestMethodWithReturnValue",0), 100);
+	for(int i = 0; i < 100; ++i)
+	{
+		results.Expect(WithReturnValue("TestMethodWithReturnValue",i));
+	}
+
+	TestMock* mock = testMock ;
+	CHECK(InWorkers(1, [mock](int)
+	{
+		for(int i = 0; i < 100; ++i)
+		{
+			if(mock->TestMethodWithReturnValue() != i)
+			{
+				return 1 ;
+			}
+		}
+		return 0 ;
+	}));
+	CHECK(mockRepository.verifyAll());
+}
+
+TEST(TestShared,TestViolationsOfWorkersFailTheParent)
+{
+	SharedQueue<WithAnArgument>& calls = mockRepository.Share(testMock, WithAnArgument("TestMethodWithAnArgument",0));
+	calls.Expect(WithAnArgument("TestMethodWithAnArgument",1));
+
+	TestMock* mock = testMock ;
+	CHECK(InWorkers(1, [mock](int)
+	{
+		mock->TestMethodWithAnArgument(2);
+		mock->TestMethodWithAnArgument(3);
+		return 0 ;
+	}));
+
+	EQUAL(2u, mockRepository.Violations().Size());
+	EQUAL("TestMethodWithAnArgument(1)", mockRepository.Violations()[0].expected);
+	EQUAL("TestMethodWithAnArgument(2)", mockRepository.Violations()[0].actual);
+	EQUAL(Violation::NotExpected, mockRepository.Violations()[1].kind);
+	EQUAL("TestMethodWithAnArgument(3)", mockRepository.Violations()[1].actual);
+
+	MockPrinter::Silent(true);
+	CHECK(!mockRepository.verifyAll());
+	MockPrinter::Silent(false);
+	EQUAL(0u, mockRepository.Violations().Size());
+}
+
+TEST(TestShared,TestVerifyingThroughTheBaseRepository)
+{
+	MockRepository<ConcreteNotifier>& repository = mockRepository ;
+	SharedQueue<WithAnArgument>& calls = mockRepository.Share(testMock, WithAnArgument("TestMethodWithAnArgument",0));
+	calls.Expect(WithAnArgument("TestMethodWithAnArgument",1));
+	calls.Expect(WithAnArgument("TestMethodWithAnArgument",2));
+
+	TestMock* mock = testMock ;
+	CHECK(InWorkers(1, [mock](int)
+	{
+		mock->TestMethodWithAnArgument(1);
+		mock->TestMethodWithAnArgument(3);
+		return 0 ;
+	}));
+
+	EQUAL(0u, repository.OutstandingExpectations());
+	EQUAL(1u, repository.Violations().Size());
+	MockPrinter::Silent(true);
+	CHECK(!repository.verifyAll());
+	MockPrinter::Silent(false);
+	EQUAL(0u, repository.Violations().Size());
+
+	calls.Expect(WithAnArgument("TestMethodWithAnArgument",4));
+	CHECK(InWorkers(1, [mock](int)
+	{
+		mock->TestMethodWithAnArgument(5);
+		return 0 ;
+	}));
+	MockPrinter::Silent(true);
+	CHECK(!repository.verify("TestMock"));
+	MockPrinter::Silent(false);
+
+	repository.Reset();
+	EQUAL(0u, calls.Pending());
+	EQUAL(0u, repository.Violations().Size());
+	calls.Expect(WithAnArgument("TestMethodWithAnArgument",6));
+	testMock->TestMethodWithAnArgument(6);
+	CHECK(repository.verifyAll());
+}
+
+TEST(TestShared,TestExpectationsLeftByWorkersAreUnhandled)
+{
+	SharedQueue<WithAnArgument>& calls = mockRepository.Share(testMock, WithAnArgument("TestMethodWithAnArgument",0));
+	for(int i = 0; i < 3; ++i)
+	{
+		calls.Expect(WithAnArgument("TestMethodWithAnArgument",i));
+	}
+
+	TestMock* mock = testMock ;
+	CHECK(InWorkers(1, [mock](int)
+	{
+		mock->TestMethodWithAnArgument(0);
+		return 0 ;
+	}));
+
+	std::stringstream pending ;
+	mockRepository.PrintPendingExpectations(pending);
+	EQUAL("TestMock::TestMethodWithAnArgument(1)\nTestMock::TestMethodWithAnArgument(2)\n", pending.str());
+	EQUAL(2u, mockRepository.OutstandingExpectations());
+
+	MockPrinter::Silent(true);
+	CHECK(!mockRepository.verifyAll());
+	MockPrinter::Silent(false);
+	EQUAL(0u, mockRepository.OutstandingExpectations());
+}
+
+TEST(TestShared,TestResetRewindsTheQueues)
+{
+	SharedQueue<WithAnArgument>& calls = mockRepository.Share(testMock, WithAnArgument("TestMethodWithAnArgument",0), 2);
+	for(int round = 0; round < 3; ++round)
+	{
+		calls.Expect(WithAnArgument("TestMethodWithAnArgument",round));
+		calls.Expect(WithAnArgument("TestMethodWithAnArgument",round));
+		testMock->TestMethodWithAnArgument(round);
+		mockRepository.Reset();
+		EQUAL(0u, mockRepository.OutstandingExpectations());
+	}
+	calls.Expect(WithAnArgument("TestMethodWithAnArgument",5));
+	calls.Expect(WithAnArgument("TestMethodWithAnArgument",5));
+	ASSERT_THROW(calls.Expect(WithAnArgument("TestMethodWithAnArgument",5)), SharedMemoryError);
+	testMock->TestMethodWithAnArgument(5);
+	testMock->TestMethodWithAnArgument(5);
+	CHECK(mockRepository.verifyAll());
+}
@@ -0,0 +1,283 @@
+#include <iostream>
+using namespace std;
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "yaffut.h"
+#include "TinyMockNet.h"
+using namespace TinyMock;
+
+#include "ConcreteNotifier.h"
+
+static sockaddr_in Loopback(unsigned short port)
+{
+	sockaddr_in address ;
+	memset(&address, 0, sizeof address);
+	address.sin_family = AF_INET ;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	address.sin_port = htons(port);
+	return address ;
+}
+
+static int Connect(unsigned short port)
+{
+	const int fd = socket(AF_INET, SOCK_STREAM, 0);
+	const sockaddr_in address = Loopback(port);
+	if(connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof address) < 0)
+	{
+		close(fd);
+		return -1 ;
+	}
+	const int on = 1 ;
+	setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof on);
+	return fd ;
+}
+
+static bool SendAll(int fd, const std::string& bytes)
+{
+	size_t sent = 0 ;
+	while(sent < bytes.size())
+	{
+		const ssize_t written = send(fd, bytes.data() + sent, bytes.size() - sent, MSG_NOSIGNAL);
+		if(written <= 0)
+		{
+			return false ;
+		}
+		sent += size_t(written);
+	}
+	return true ;
+}
+
+// 'size' bytes, or fewer if the connection ends first
+static std::string Receive(int fd, size_t size)
+{
+	std::string received(size, '\0');
+	size_t got = 0 ;
+	while(got < size)
+	{
+		const ssize_t n = recv(fd, &received[got], size - got, 0);
+		if(n <= 0)
+		{
+			break ;
+		}
+		got += size_t(n);
+	}
+	received.resize(got);
+	return received ;
+}
+
+struct TestStandIn
+{
+    TestStandIn()
+    {
+		server = mockRepository.CreateMock<StandInServer,ConcreteNotifier>("Server");
+    }
+
+    ~TestStandIn()
+    {
+    }
+
+	MockRepository<ConcreteNotifier> mockRepository ;
+	StandInServer* server ;
+};
+
+TEST(TestStandIn,TestPipelinedRequestsGetTheScriptedResponses)
+{
+	server->request.Expect("GET a\n").Returns("A\n");
+	server->request.Expect("GET b\n").Returns(StandInResponse("B\n"));
+	server->Start();
+
+	const int client = Connect(server->TcpPort());
+	CHECK(SendAll(client, "GET a\nGET "));
+	CHECK(SendAll(client, "b\n"));
+	EQUAL("A\nB\n", Receive(client, 4));
+	close(client);
+
+	server->Stop();
+	EQUAL(1u, server->Connections());
+	EQUAL(2u, server->Requests());
+	CHECK(mockRepository.verifyAll());
+}
+
+TEST(TestStandIn,TestADelayedResponseHoldsBackTheNextOne)
+{
+	server->request.Expect("slow\n").Returns(StandInResponse("S\n").After(50));
+	server->request.Expect("fast\n").Returns("F\n");
+	server->Start();
+
+	const int client = Connect(server->TcpPort());
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	CHECK(SendAll(client, "slow\nfast\n"));
+	EQUAL("S\nF\n", Receive(client, 4));
+	CHECK(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(50));
+	close(client);
+
+	server->Stop();
+	CHECK(mockRepository.verifyAll());
+}
+
+TEST(TestStandIn,TestAConnectionIsReset)
+{
+	server->request.Expect("reset me\n").Returns(StandInResponse::Reset());
+	server->Start();
+
+	const int client = Connect(server->TcpPort());
+	CHECK(SendAll(client, "reset me\n"));
+	char byte ;
+	errno = 0 ;
+	EQUAL(-1, int(recv(client, &byte, 1, 0)));
+	EQUAL(ECONNRESET, errno);
+	close(client);
+
+	server->Stop();
+	CHECK(mockRepository.verifyAll());
+}
+
+TEST(TestStandIn,TestAResetComesAfterTheResponsesBeforeIt)
+{
+	server->request.Expect("a\n").Returns("A\n");
+	server->request.Expect("b\n").Returns(StandInResponse::Reset());
+	server->Start();
+
+	const int client = Connect(server->TcpPort());
+	CHECK(SendAll(client, "a\nb\n"));
+	EQUAL("A\n", Receive(client, 2));
+	char byte ;
+	errno = 0 ;
+	EQUAL(-1, int(recv(client, &byte, 1, 0)));
+	EQUAL(ECONNRESET, errno);
+	close(client);
+
+	server->Stop();
+	CHECK(mockRepository.verifyAll());
+}
+
+TEST(TestStandIn,TestRequestsOfOtherFramings)
+{
+	server->Frame([](const char*, size_t size) { return size >= 3 ? size_t(3) : size_t(0); });
+	server->request.Expect("abc").Returns("1");
+	server->request.Expect("def").Returns("2");
+	server->Start();
+
+	const int client = Connect(server->TcpPort());
+	CHECK(SendAll(client, "abcdef"));
+	EQUAL("12", Receive(client, 2));
+	close(client);
+
+	server->Stop();
+	CHECK(mockRepository.verifyAll());
+}
+
+TEST(TestStandIn,TestAnUnexpectedRequestIsAViolation)
+{
+	mockRepository.CollectViolations();
+	server->request.Expect("expected\n").Returns("yes\n");
+	server->Start();
+
+	const int client = Connect(server->TcpPort());
+	CHECK(SendAll(client, "expected\nsurprise\nexpected\n"));
+	EQUAL("yes\n", Receive(client, 4));
+	while(server->Requests() < 3)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	close(client);
+	server->Stop();
+
+	EQUAL(2u, mockRepository.Violations().Size());
+	EQUAL("request(surprise\n)", mockRepository.Violations()[0].actual);
+	MockPrinter::Silent(true);
+	CHECK(!mockRepository.verifyAll());
+	MockPrinter::Silent(false);
+}
+
+TEST(TestStandIn,TestDatagrams)
+{
+	server->request.Expect("ping").Returns("pong");
+	server->request.Expect("later").Returns(StandInResponse("now").After(20));
+	server->Start();
+
+	const int client = socket(AF_INET, SOCK_DGRAM, 0);
+	const sockaddr_in address = Loopback(server->UdpPort());
+	char answer[16];
+	sendto(client, "ping", 4, 0, reinterpret_cast<const sockaddr*>(&address), sizeof address);
+	EQUAL(4, int(recv(client, answer, sizeof answer, 0)));
+	EQUAL("pong", std::string(answer, 4));
+	sendto(client, "later", 5, 0, reinterpret_cast<const sockaddr*>(&address), sizeof address);
+	EQUAL(3, int(recv(client, answer, sizeof answer, 0)));
+	EQUAL("now", std::string(answer, 3));
+	close(client);
+
+	server->Stop();
+	CHECK(mockRepository.verifyAll());
+}
+
+TEST(TestStandIn,TestConnectionPoolsUnderLoad)
+{
+	const int threads = 8, connections = 8, rounds = 20, pipelined = 16 ;
+	const size_t requests = size_t(threads) * connections * rounds * pipelined ;
+	for(size_t r = 0; r < requests; ++r)
+	{
+		server->request.Expect("req\n").Returns("ok\n");
+	}
+	server->Start();
+
+	std::vector<int> answered(threads, 0);
+	std::vector<std::thread> pools ;
+	const unsigned short port = server->TcpPort();
+	for(int t = 0; t < threads; ++t)
+	{
+		pools.push_back(std::thread([&answered, t, port]()
+		{
+			std::vector<int> pool ;
+			for(int c = 0; c < connections; ++c)
+			{
+				pool.push_back(Connect(port));
+			}
+			std::string batch, expected ;
+			for(int p = 0; p < pipelined; ++p)
+			{
+				batch += "req\n" ;
+				expected += "ok\n" ;
+			}
+			for(int r = 0; r < rounds; ++r)
+			{
+				for(int c = 0; c < connections; ++c)
+				{
+					SendAll(pool[c], batch);
+				}
+				for(int c = 0; c < connections; ++c)
+				{
+					answered[t] += Receive(pool[c], expected.size()) == expected ? pipelined : 0 ;
+				}
+			}
+			for(int c = 0; c < connections; ++c)
+			{
+				close(pool[c]);
+			}
+		}));
+	}
+	for(int t = 0; t < threads; ++t)
+	{
+		pools[t].join();
+	}
+
+	server->Stop();
+	size_t total = 0 ;
+	for(int t = 0; t < threads; ++t)
+	{
+		total += size_t(answered[t]);
+	}
+	EQUAL(requests, total);
+	EQUAL(size_t(threads * connections), server->Connections());
+	EQUAL(requests, server->Requests());
+	CHECK(mockRepository.verifyAll());
+}
@@ -0,0 +1,146 @@
+#include <iostream>
+using namespace std;
+#include <sstream>
+
+#include "yaffut.h"
+#include "TinyMock.h"
+using namespace TinyMock;
+
+#include "ConcreteNotifier.h"
+
+class StaticTestMock : public StaticMock<StaticTestMock>
+{
+public:
+	StaticTestMock(const std::string& className)
+		: StaticMock<StaticTestMock>(className),
+		  testMethod(*this, "TestMethod"),
+		  testMethodWithAnArgument(*this, "TestMethodWithAnArgument"),
+		  testMethodWithReturnValue(*this, "TestMethodWithReturnValue")
+	{
+	}
+	void TestMethod() { testMethod(); }
+	void TestMethodWithAnArgument(int arg) { testMethodWithAnArgument(arg); }
+	int TestMethodWithReturnValue() { return testMethodWithReturnValue(); }
+
+	StaticMethod<StaticTestMock, void()> testMethod ;
+	StaticMethod<StaticTestMock, void(int)> testMethodWithAnArgument ;
+	StaticMethod<StaticTestMock, int()> testMethodWithReturnValue ;
+};
+
+// Matches arguments that are equal modulo 10.
+class ModuloTestMock : public StaticMock<ModuloTestMock>
+{
+public:
+	ModuloTestMock(const std::string& className)
+		: StaticMock<ModuloTestMock>(className), testMethodWithAnArgument(*this, "TestMethodWithAnArgument")
+	{
+	}
+	static bool Matches(const std::tuple<int>& expected, const std::tuple<const int&>& actual)
+	{
+		return std::get<0>(expected) % 10 == std::get<0>(actual) % 10 ;
+	}
+	void TestMethodWithAnArgument(int arg) { testMethodWithAnArgument(arg); }
+
+	StaticMethod<ModuloTestMock, void(int)> testMethodWithAnArgument ;
+};
+
+// The dependency is a template parameter, so calls on it are not virtual.
+template <typename Dependency>
+class Doubler
+{
+public:
+	Doubler(Dependency& dependency) : m_dependency(dependency) {}
+	int Run(int arg)
+	{
+		m_dependency.TestMethod();
+		m_dependency.TestMethodWithAnArgument(arg);
+		return 2 * m_dependency.TestMethodWithReturnValue();
+	}
+private:
+	Dependency& m_dependency ;
+};
+
+struct TestStaticMock
+{
+    TestStaticMock()
+    {
+    }
+
+    ~TestStaticMock()
+    {
+    }
+};
+
+TEST(TestStaticMock,TestExpectationsAreMetThroughATemplateParameter)
+{
+	MockRepository<ConcreteNotifier> mockRepository ;
+	StaticTestMock* staticMock = mockRepository.CreateMock<StaticTestMock,ConcreteNotifier>("StaticTestMock");
+
+	staticMock->testMethod.Expect();
+	staticMock->testMethodWithAnArgument.Expect(5);
+	staticMock->testMethodWithReturnValue.Expect().Returns(21);
+	EQUAL(3u, mockRepository.OutstandingExpectations());
+
+	EQUAL(42, Doubler<StaticTestMock>(*staticMock).Run(5));
+
+	EQUAL(0u, mockRepository.OutstandingExpectations());
+	CHECK(mockRepository.verifyAll());
+}
+
+TEST(TestStaticMock,TestViolationsAreReportedLikeThoseOfAMock)
+{
+	MockRepository<ConcreteNotifier> mockRepository ;
+	mockRepository.CollectViolations();
+	StaticTestMock* staticMock = mockRepository.CreateMock<StaticTestMock,ConcreteNotifier>("StaticTestMock");
+
+	staticMock->testMethodWithAnArgument.Expect(5);
+	staticMock->TestMethodWithAnArgument(6);
+	staticMock->TestMethod();
+
+	EQUAL(2u, mockRepository.Violations().Size());
+	EQUAL(Violation::ExpectedAndActualDifferent, mockRepository.Violations()[0].kind);
+	EQUAL("TestMethodWithAnArgument(5)", mockRepository.Violations()[0].expected);
+	EQUAL("TestMethodWithAnArgument(6)", mockRepository.Violations()[0].actual);
+	EQUAL(Violation::NotExpected, mockRepository.Violations()[1].kind);
+	EQUAL("TestMethod()", mockRepository.Violations()[1].actual);
+
+	MockPrinter::Silent(true);
+	CHECK(!mockRepository.verifyAll());
+	MockPrinter::Silent(false);
+}
+
+TEST(TestStaticMock,TestUnhandledExpectationsFailVerification)
+{
+	MockRepository<ConcreteNotifier> mockRepository ;
+	StaticTestMock* staticMock = mockRepository.CreateMock<StaticTestMock,ConcreteNotifier>("StaticTestMock");
+
+	staticMock->testMethodWithAnArgument.Expect(5);
+	staticMock->testMethodWithAnArgument.Expect(0).ignoreArguments();
+	staticMock->TestMethodWithAnArgument(5);
+
+	std::stringstream pending ;
+	mockRepository.PrintPendingExpectations(pending);
+	EQUAL("StaticTestMock::TestMethodWithAnArgument(0)\n", pending.str());
+
+	MockPrinter::Silent(true);
+	CHECK(!mockRepository.verifyAll());
+	MockPrinter::Silent(false);
+	EQUAL(0u, mockRepository.OutstandingExpectations());
+
+	staticMock->testMethod.Expect();
+	mockRepository.Reset();
+	CHECK(mockRepository.verifyAll());
+}
+
+TEST(TestStaticMock,TestDerivedMockComparesArgumentsItsOwnWay)
+{
+	MockRepository<ConcreteNotifier> mockRepository ;
+	mockRepository.CollectViolations();
+	ModuloTestMock* moduloMock = mockRepository.CreateMock<ModuloTestMock,ConcreteNotifier>("ModuloTestMock");
+
+	moduloMock->testMethodWithAnArgument.Expect(3);
+	moduloMock->TestMethodWithAnArgument(13);
+
+	CHECK(mockRepository.Violations().IsEmpty());
+	CHECK(mockRepository.verifyAll());
+}
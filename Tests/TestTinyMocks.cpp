@@ -309,3 +309,135 @@ TEST(TestTinyMock,TestIfAMethodIsCalled)
 
 	mockRepository.verifyAll();
 }
+
+TEST(TestTinyMock,CollectingViolationsDoesNotNotifyAndReportsAllOfThemAtVerifyAll)
+{
+	ConcreteNotifier notifier ;
+
+	MockRepository<> mockRepository;
+	mockRepository.CollectViolations();
+
+        TestMock* testMock = mockRepository.CreateMock<TestMock, ExceptionFailureNotifier>("TestMock");
+
+        testMock->RegisterExpectation(new TinyMock::Method<int,void,void,void,void>("TestMethodWithAnArgument",25));
+
+	testMock->TestMethodWithAnArgument(24);
+	testMock->TestMethod();
+
+	EQUAL(2u, mockRepository.Violations().Size());
+	CHECK(mockRepository.Violations()[0].kind == Violation::ExpectedAndActualDifferent);
+	EQUAL("TestMethodWithAnArgument(25)", mockRepository.Violations()[0].expected);
+	EQUAL("TestMethodWithAnArgument(24)", mockRepository.Violations()[0].actual);
+	CHECK(mockRepository.Violations()[1].kind == Violation::NotExpected);
+
+	CHECK(!mockRepository.verifyAll(notifier));
+	CHECK(notifier.sendWasCalled);
+	EQUAL(0u, mockRepository.Violations().Size());
+
+	notifier.ResetNotificationFlag();
+
+	CHECK(mockRepository.verifyAll(notifier));
+	CHECK(!notifier.sendWasCalled);
+}
+
+TEST(TestTinyMock,CollectingViolationsBeyondTheCapacityOfTheLogOnlyCountsThem)
+{
+	ConcreteNotifier notifier ;
+
+	MockRepository<> mockRepository;
+
+        TestMock* testMock = mockRepository.CreateMock<TestMock, ExceptionFailureNotifier>("TestMock");
+
+	mockRepository.CollectViolations(1);
+
+	testMock->TestMethod();
+	testMock->TestMethod();
+	testMock->TestMethod();
+
+	EQUAL(1u, mockRepository.Violations().Size());
+	EQUAL(2u, mockRepository.Violations().Dropped());
+
+	CHECK(!mockRepository.verifyAll(notifier));
+}
+
+TEST(TestTinyMock,StubbingAMethodToReturnAConstantWithoutVerifyingItsCalls)
+{
+	MockRepository<YaffutFailureNotifier> mockRepository;
+
+        TestMock* testMock = mockRepository.CreateMock<TestMock, ExceptionFailureNotifier>("TestMock");
+
+	testMock->Stub<int>("TestMethodWithReturnValue").Returns(7);
+	testMock->Stub<void>("TestMethod");
+
+	for(int i = 0; i < 1000; ++i)
+	{
+		EQUAL(7, testMock->TestMethodWithReturnValue());
+		testMock->TestMethod();
+	}
+
+	mockRepository.verifyAll();
+}
+
+TEST(TestTinyMock,StubbingAMethodToReturnValuesFromASequenceInTurn)
+{
+	MockRepository<YaffutFailureNotifier> mockRepository;
+
+        TestMock* testMock = mockRepository.CreateMock<TestMock, ExceptionFailureNotifier>("TestMock");
+
+	std::vector<int> values ;
+	values.push_back(1);
+	values.push_back(2);
+	values.push_back(3);
+	testMock->Stub<int>("TestMethodWithReturnValue").ReturnsInTurn(values);
+
+	EQUAL(1, testMock->TestMethodWithReturnValue());
+	EQUAL(2, testMock->TestMethodWithReturnValue());
+	EQUAL(3, testMock->TestMethodWithReturnValue());
+	EQUAL(1, testMock->TestMethodWithReturnValue());
+}
+
+TEST(TestTinyMock,StubbingAMethodWithAFunctor)
+{
+	MockRepository<YaffutFailureNotifier> mockRepository;
+
+        TestMock* testMock = mockRepository.CreateMock<TestMock, ExceptionFailureNotifier>("TestMock");
+
+	int calls = 0 ;
+	testMock->Stub<int>("TestMethodWithReturnValue").Calls([&calls]() { return ++calls * 10; });
+	testMock->Stub<void>("TestMethod").Calls([&calls]() { calls += 100; });
+
+	EQUAL(10, testMock->TestMethodWithReturnValue());
+	testMock->TestMethod();
+	EQUAL(1020, testMock->TestMethodWithReturnValue());
+}
+
+TEST(TestTinyMock,StubsOfTheSameNameWithOtherResultTypesAreApart)
+{
+	MockRepository<> mockRepository;
+	mockRepository.CollectViolations();
+
+        TestMock* testMock = mockRepository.CreateMock<TestMock, ExceptionFailureNotifier>("TestMock");
+
+	testMock->Stub<std::string>("TestMethodWithReturnValue").Returns("seven");
+	CHECK(TinyMock::StubId("TestMethodWithReturnValue", typeid(int)).Index() != TinyMock::StubId("TestMethodWithReturnValue", typeid(std::string)).Index());
+
+	EQUAL(0, testMock->TestMethodWithReturnValue());
+	EQUAL(1u, mockRepository.Violations().Size());
+}
+
+TEST(TestTinyMock,ResettingTheMockRemovesItsStubs)
+{
+	MockRepository<> mockRepository;
+	mockRepository.CollectViolations();
+
+        TestMock* testMock = mockRepository.CreateMock<TestMock, ExceptionFailureNotifier>("TestMock");
+
+	testMock->Stub<int>("TestMethodWithReturnValue").Returns(7);
+	EQUAL(7, testMock->TestMethodWithReturnValue());
+
+	mockRepository.Reset();
+
+	EQUAL(0, testMock->TestMethodWithReturnValue());
+	EQUAL(1u, mockRepository.Violations().Size());
+	CHECK(mockRepository.Violations()[0].kind == Violation::NotExpected);
+}
@@ -0,0 +1,218 @@
+#include <iostream>
+using namespace std;
+#include <stdio.h>
+#include <unistd.h>
+#include <string>
+
+#include "yaffut.h"
+#include "TinyMockTrace.h"
+using namespace TinyMock;
+
+#include "ConcreteNotifier.h"
+#include "TestMock.h"
+
+class RealTest : public Test
+{
+public:
+	RealTest() : m_calls(0) {}
+	void TestMethod() { ++m_calls; }
+	void TestMethodWithAnArgument(int arg) { m_calls += arg; }
+	int TestMethodWithReturnValue() { return m_calls; }
+	void TestMethodWithAPointerArgument(ComplexArgument* p_arg) {}
+private:
+	int m_calls ;
+};
+
+enum RecordedMethod { TestMethodId, TestMethodWithAnArgumentId, TestMethodWithReturnValueId };
+
+// Records the calls that go through to the real implementation.
+class RecordingTest : public Test
+{
+public:
+	RecordingTest(Test& real, TraceWriter& trace) : m_real(real), m_trace(trace) {}
+	void TestMethod()
+	{
+		m_real.TestMethod();
+		m_trace.Record(TestMethodId);
+	}
+	void TestMethodWithAnArgument(int arg)
+	{
+		m_real.TestMethodWithAnArgument(arg);
+		m_trace.Record(TestMethodWithAnArgumentId, arg);
+	}
+	int TestMethodWithReturnValue()
+	{
+		const int result = m_real.TestMethodWithReturnValue();
+		m_trace.Record(TestMethodWithReturnValueId, result);
+		return result ;
+	}
+	void TestMethodWithAPointerArgument(ComplexArgument* p_arg)
+	{
+		m_real.TestMethodWithAPointerArgument(p_arg);
+	}
+private:
+	Test& m_real ;
+	TraceWriter& m_trace ;
+};
+
+static int Exercise(Test& dependency, int rounds)
+{
+	int last = 0 ;
+	for(int i = 0; i < rounds; ++i)
+	{
+		dependency.TestMethod();
+		dependency.TestMethodWithAnArgument(i % 7);
+		last = dependency.TestMethodWithReturnValue();
+	}
+	return last ;
+}
+
+static void ReplayInto(TraceReplayer& replayer, TestMock* testMock)
+{
+	replayer.On<>(TestMethodId, [testMock]()
+	{
+		testMock->RegisterExpectation(new TinyMock::Method<void,void,void,void,void>("TestMethod"));
+	});
+	replayer.On<int>(TestMethodWithAnArgumentId, [testMock](int arg)
+	{
+		testMock->RegisterExpectation(new TinyMock::Method<int,void,void,void,void>("TestMethodWithAnArgument",arg));
+	});
+	replayer.On<int>(TestMethodWithReturnValueId, [testMock](int result)
+	{
+		testMock->RegisterExpectation(new TinyMock::Method<void,void,void,void,int>("TestMethodWithReturnValue",result));
+	});
+}
+
+struct TestTrace
+{
+    TestTrace() : path("TestTrace.trace")
+    {
+    }
+
+    ~TestTrace()
+    {
+		remove(path.c_str());
+    }
+
+	std::string path ;
+};
+
+TEST(TestTrace,TestReplayingARecordedSession)
+{
+	RealTest real ;
+	int recorded = 0 ;
+	{
+		TraceWriter trace(path, 64);
+		RecordingTest recording(real, trace);
+		recorded = Exercise(recording, 1000);
+		EQUAL(3000u, trace.Records());
+	}
+
+	MockRepository<ConcreteNotifier> mockRepository ;
+	TestMock* testMock = mockRepository.CreateMock<TestMock,ConcreteNotifier>("TestMock");
+	TraceReader trace(path, 64);
+	EQUAL(3000u, trace.Records());
+	TraceReplayer replayer(trace);
+	ReplayInto(replayer, testMock);
+
+	EQUAL(3000u, replayer.ReplayAll());
+	EQUAL(3000u, mockRepository.OutstandingExpectations());
+	EQUAL(recorded, Exercise(*testMock, 1000));
+	CHECK(mockRepository.verifyAll());
+}
+
+TEST(TestTrace,TestStringsAndMixedValues)
+{
+	{
+		TraceWriter trace(path);
+		trace.Record(1, std::string("open"), 3, true);
+		trace.Record(2, std::string(), 2.5);
+	}
+
+	TraceReader trace(path);
+	TraceReplayer replayer(trace);
+	std::string replayed ;
+	replayer.On<std::string,int,bool>(1, [&replayed](std::string name, int flags, bool result)
+	{
+		std::stringstream out ;
+		out << name << "," << flags << "," << result << ";" ;
+		replayed += out.str();
+	});
+	replayer.On<std::string,double>(2, [&replayed](std::string name, double value)
+	{
+		std::stringstream out ;
+		out << "[" << name << "]," << value << ";" ;
+		replayed += out.str();
+	});
+	EQUAL(2u, replayer.ReplayAll());
+	EQUAL(std::string("open,3,1;[],2.5;"), replayed);
+}
+
+TEST(TestTrace,TestTruncatedTraceIsAnError)
+{
+	{
+		TraceWriter trace(path);
+		trace.Record(TestMethodWithAnArgumentId, 42);
+	}
+	FILE* file = fopen(path.c_str(), "r+b");
+	fseek(file, 0, SEEK_END);
+	const long size = ftell(file);
+	fclose(file);
+	CHECK(truncate(path.c_str(), size - 1) == 0);
+
+	TraceReader trace(path);
+	TraceReplayer replayer(trace);
+	replayer.On<int>(TestMethodWithAnArgumentId, [](int) {});
+	try
+	{
+		replayer.ReplayAll();
+		FAIL("truncated trace replayed");
+	}
+	catch(const TraceError&)
+	{
+	}
+}
+
+// the lowest descriptor free, which a leaked file would take
+static int FreeDescriptor()
+{
+	const int fd = dup(0);
+	close(fd);
+	return fd ;
+}
+
+TEST(TestTrace,TestFileThatIsNotATrace)
+{
+	const char* contents[] = { "TM", "not a trace at all" };
+	for(size_t c = 0; c < 2; ++c)
+	{
+		FILE* file = fopen(path.c_str(), "wb");
+		fputs(contents[c], file);
+		fclose(file);
+		const int unused = FreeDescriptor();
+		try
+		{
+			TraceReader trace(path);
+			FAIL("not a trace accepted");
+		}
+		catch(const TraceError& e)
+		{
+			EQUAL(path + " is not a trace", std::string(e.what()));
+		}
+		EQUAL(unused, FreeDescriptor());
+	}
+}
+
+TEST(TestTrace,TestFailingToWriteATrace)
+{
+	{
+		TraceWriter trace("/dev/full");
+		trace.Record(TestMethodWithAnArgumentId, 42);
+		ASSERT_THROW(trace.Close(), TraceError);
+	}
+	{
+		// the destructor does not throw
+		TraceWriter trace("/dev/full");
+		trace.Record(TestMethodWithAnArgumentId, 42);
+	}
+}
@@ -0,0 +1,139 @@
+#include <iostream>
+using namespace std;
+#include <chrono>
+
+#include "yaffut.h"
+#include "TinyMockClock.h"
+#include "TinyMockFuzz.h"
+using namespace TinyMock;
+
+#include "ConcreteNotifier.h"
+#include "TestMock.h"
+
+class ConnectionMock : public StaticMock<ConnectionMock>
+{
+public:
+	ConnectionMock(const std::string& className)
+		: StaticMock<ConnectionMock>(className), connect(*this, "Connect")
+	{
+	}
+	bool Connect() { return connect(); }
+
+	StaticMethod<ConnectionMock, bool()> connect ;
+};
+
+// Retries with exponential backoff, as the services under test do.
+template <typename Connection>
+class Connector
+{
+public:
+	Connector(Connection& connection, Clock& clock) : m_connection(connection), m_clock(clock) {}
+	int Connect(int attempts, Clock::Duration backoff)
+	{
+		for(int attempt = 1; attempt <= attempts; ++attempt)
+		{
+			if(m_connection.Connect())
+			{
+				return attempt ;
+			}
+			m_clock.SleepFor(backoff);
+			backoff *= 2 ;
+		}
+		return 0 ;
+	}
+private:
+	Connection& m_connection ;
+	Clock& m_clock ;
+};
+
+struct TestVirtualClock
+{
+    TestVirtualClock()
+    {
+    }
+
+    ~TestVirtualClock()
+    {
+    }
+};
+
+TEST(TestVirtualClock,TestBackoffOfMinutesTakesNoTime)
+{
+	MockRepository<ConcreteNotifier> mockRepository ;
+	ConnectionMock* connection = mockRepository.CreateMock<ConnectionMock,ConcreteNotifier>("Connection");
+	VirtualClock clock ;
+
+	for(int i = 0; i < 10; ++i)
+	{
+		connection->connect.Expect().Returns(false);
+	}
+	connection->connect.Expect().Returns(true);
+
+	const std::chrono::steady_clock::time_point started = std::chrono::steady_clock::now();
+	EQUAL(11, Connector<ConnectionMock>(*connection, clock).Connect(20, std::chrono::seconds(1)));
+
+	CHECK(clock.Now() == std::chrono::seconds(1023));
+	CHECK(std::chrono::steady_clock::now() - started < std::chrono::seconds(1));
+	CHECK(mockRepository.verifyAll());
+}
+
+TEST(TestVirtualClock,TestTimersRunInOrderWhenTheClockMoves)
+{
+	VirtualClock clock ;
+	std::vector<int> fired ;
+	clock.Schedule(std::chrono::milliseconds(20), [&fired]() { fired.push_back(2); });
+	clock.Schedule(std::chrono::milliseconds(10), [&fired]() { fired.push_back(1); });
+	clock.Schedule(std::chrono::milliseconds(20), [&fired]() { fired.push_back(3); });
+
+	clock.AdvanceBy(std::chrono::milliseconds(15));
+	EQUAL(1u, fired.size());
+	CHECK(clock.Now() == std::chrono::milliseconds(15));
+
+	clock.Schedule(std::chrono::milliseconds(100), [&clock, &fired]()
+	{
+		fired.push_back(4);
+		clock.Schedule(std::chrono::milliseconds(1), [&fired]() { fired.push_back(5); });
+	});
+	EQUAL(4u, clock.RunUntilIdle());
+
+	const int expected[] = { 1, 2, 3, 4, 5 };
+	CHECK(fired == std::vector<int>(expected, expected + 5));
+	CHECK(clock.Now() == std::chrono::milliseconds(116));
+}
+
+TEST(TestVirtualClock,TestSlowCallsAdvanceTheClock)
+{
+	MockRepository<ConcreteNotifier> mockRepository ;
+	ConnectionMock* connection = mockRepository.CreateMock<ConnectionMock,ConcreteNotifier>("Connection");
+	TestMock* testMock = mockRepository.CreateMock<TestMock,ConcreteNotifier>("TestMock");
+	VirtualClock clock ;
+
+	bool timedOut = false ;
+	clock.Schedule(std::chrono::seconds(1), [&timedOut]() { timedOut = true; });
+	connection->connect.Expect().Returns(true).AddNotifier(clock.Delay(std::chrono::seconds(2)));
+	testMock->RegisterExpectation(new TinyMock::Method<void,void,void,void,void>("TestMethod")).AddNotifier(clock.Delay(std::chrono::milliseconds(500)));
+
+	CHECK(connection->Connect());
+	CHECK(timedOut);
+	testMock->TestMethod();
+
+	CHECK(clock.Now() == std::chrono::milliseconds(2500));
+	CHECK(mockRepository.verifyAll());
+}
+
+TEST(TestVirtualClock,TestFuzzedDelaysAdvanceTheClock)
+{
+	MockRepository<ConcreteNotifier> mockRepository ;
+	TestMock* testMock = mockRepository.CreateMock<TestMock,ConcreteNotifier>("TestMock");
+	VirtualClock clock ;
+
+	FuzzDriver driver ;
+	driver.AddChannel(testMock, TinyMock::Method<void,void,void,void,int>("TestMethodWithReturnValue",0), 4);
+	driver.OnDelay([&clock](unsigned milliseconds) { clock.AdvanceBy(std::chrono::milliseconds(milliseconds)); });
+
+	const uint8_t input[] = { 0, FuzzResponse::Delay, 250, 0, 1, 0, 0, 0 };
+	driver.Load(input, sizeof(input));
+	EQUAL(1, testMock->TestMethodWithReturnValue());
+
+	CHECK(clock.Now() == std::chrono::milliseconds(250));
+}
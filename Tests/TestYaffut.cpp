@@ -0,0 +1,334 @@
+#include <iostream>
+using namespace std;
+#include <stdexcept>
+#include <thread>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "yaffut.h"
+
+struct TestYaffut
+{
+    TestYaffut()
+    {        
+    }
+	
+    ~TestYaffut()
+    {        
+    }
+};
+
+static void FinishingTest()
+{
+}
+
+static void SlowTest()
+{
+	std::this_thread::sleep_for(std::chrono::milliseconds(200));
+}
+
+static void FailingTest()
+{
+	throw std::runtime_error("failing test");
+}
+
+static void AllocatingTest()
+{
+	::operator delete(::operator new(100));
+}
+
+struct ExpensiveFixture
+{
+	ExpensiveFixture() : value(42)
+	{
+		++constructed;
+	}
+	~ExpensiveFixture()
+	{
+		++destroyed;
+	}
+	int value ;
+	static int constructed ;
+	static int destroyed ;
+};
+int ExpensiveFixture::constructed = 0 ;
+int ExpensiveFixture::destroyed = 0 ;
+
+struct TestSharedFixture : yaffut::SuiteFixture<ExpensiveFixture>
+{
+};
+
+TEST(TestSharedFixture,TestTheSharedFixtureIsConstructedForTheFirstTest)
+{
+	EQUAL(1, ExpensiveFixture::constructed);
+	EQUAL(42, Shared().value);
+	Shared().value = 43 ;
+}
+
+TEST(TestSharedFixture,TestTheSharedFixtureIsNotConstructedAgainForTheNextTest)
+{
+	EQUAL(1, ExpensiveFixture::constructed);
+	CHECK(Shared().value == 42 || Shared().value == 43);
+}
+
+struct CountedFixture
+{
+	CountedFixture()
+	{
+		++constructed;
+	}
+	~CountedFixture()
+	{
+		++destroyed;
+	}
+	static int constructed ;
+	static int destroyed ;
+};
+int CountedFixture::constructed = 0 ;
+int CountedFixture::destroyed = 0 ;
+
+struct CountedSuite : yaffut::SuiteFixture<CountedFixture>
+{
+};
+
+TEST(TestYaffut,TestTheSharedFixtureIsDestroyedAfterTheLastTestOfItsSuite)
+{
+	// a suite of three tests, run the way the Factory runs a plan
+	yaffut::SharedFixture_t* fixture = yaffut::SharedFixtureOf(static_cast<CountedSuite*>(0));
+	yaffut::SharedFixtureLifetimes fixtures ;
+	const int constructed = CountedFixture::constructed ;
+	const int destroyed = CountedFixture::destroyed ;
+	for(int test = 0; test < 3; ++test)
+	{
+		fixtures.Plan(fixture);
+	}
+	for(int test = 0; test < 3; ++test)
+	{
+		fixtures.Begin(fixture);
+		EQUAL(constructed + 1, CountedFixture::constructed);
+		EQUAL(destroyed, CountedFixture::destroyed);
+		fixtures.End(fixture);
+	}
+	EQUAL(constructed + 1, CountedFixture::constructed);
+	EQUAL(destroyed + 1, CountedFixture::destroyed);
+}
+
+TEST(TestYaffut,TestShardsSplitTheTestsWithoutOverlap)
+{
+	for(size_t test = 0; test < 10; ++test)
+	{
+		int shardsRunningTheTest = 0 ;
+		for(size_t shard = 0; shard < 3; ++shard)
+		{
+			shardsRunningTheTest += yaffut::Factory::InShard(test, shard, 3) ? 1 : 0 ;
+		}
+		EQUAL(1, shardsRunningTheTest);
+	}
+}
+
+TEST(TestYaffut,TestWatchdogLetsATestFinishingInTimePass)
+{
+	yaffut::Factory::RunWithWatchdog(&FinishingTest, 1000);
+}
+
+TEST(TestYaffut,TestWatchdogAbandonsATestThatDoesNotFinishInTime)
+{
+	ASSERT_THROW(yaffut::Factory::RunWithWatchdog(&SlowTest, 10), yaffut::timeout);
+}
+
+TEST(TestYaffut,TestWatchdogPassesOnTheFailureOfTheWatchedTest)
+{
+	ASSERT_THROW(yaffut::Factory::RunWithWatchdog(&FailingTest, 1000), std::runtime_error);
+}
+
+TEST_TIMEOUT(TestYaffut,TestATestCanHaveItsOwnTimeout,5000)
+{
+	EQUAL(5000u, yaffut::Factory::Instance().TimeoutFor("TestYaffut::TestATestCanHaveItsOwnTimeout"));
+}
+
+TEST(TestYaffut,TestABlockThatDoesNotAllocate)
+{
+	std::vector<int> reserved ;
+	reserved.reserve(10);
+	ASSERT_NO_ALLOC
+	{
+		for(int i = 0; i < 10; ++i)
+		{
+			reserved.push_back(i);
+		}
+	}
+	EQUAL(10u, reserved.size());
+}
+
+TEST(TestYaffut,TestABlockThatAllocatesFailsNoAllocation)
+{
+	try
+	{
+		ASSERT_NO_ALLOC
+		{
+			AllocatingTest();
+		}
+	}
+	catch(const yaffut::failure& e)
+	{
+		CHECK(std::string(e.what()).find("ASSERT_NO_ALLOC failed: 1 allocations, 100 bytes") != std::string::npos);
+		return ;
+	}
+	FAIL("allocation not noticed");
+}
+
+TEST(TestYaffut,TestMaximumNumberOfAllocations)
+{
+	ASSERT_MAX_ALLOCS(1)
+	{
+		AllocatingTest();
+	}
+	ASSERT_THROW(ASSERT_MAX_ALLOCS(1) { AllocatingTest(); AllocatingTest(); }, yaffut::failure);
+}
+
+TEST(TestYaffut,TestWatchdogCountsTheAllocationsOfTheTestThreadOnly)
+{
+	const yaffut::AllocationCount idle = yaffut::Factory::RunWithWatchdog(&FinishingTest, 1000);
+	EQUAL(0ull, idle.allocations);
+	const yaffut::AllocationCount allocating = yaffut::Factory::RunWithWatchdog(&AllocatingTest, 1000);
+	EQUAL(1ull, allocating.allocations);
+	EQUAL(100ull, allocating.bytes);
+}
+
+struct Counter
+{
+	Counter() : calls(0) {}
+	void Operation() { yaffut::DoNotOptimize(++calls); }
+	unsigned long long calls ;
+};
+
+TEST(TestYaffut,TestMedianAndMedianAbsoluteDeviation)
+{
+	EQUAL(2.0, yaffut::Median({3.0, 1.0, 2.0}));
+	EQUAL(2.5, yaffut::Median({4.0, 1.0, 3.0, 2.0}));
+	EQUAL(0.0, yaffut::Median({}));
+	EQUAL(1.0, yaffut::MedianAbsoluteDeviation({1.0, 2.0, 3.0, 4.0, 100.0}));
+}
+
+TEST(TestYaffut,TestBenchCalibratesWarmsUpAndSamples)
+{
+	Counter counter ;
+	const yaffut::BenchResult result = yaffut::RunBench(counter, &Counter::Operation, 5, 1);
+	EQUAL(5u, result.samples);
+	CHECK(result.iterations > 1);
+	CHECK(counter.calls >= 6 * result.iterations);
+	CHECK(result.median > 0);
+	CHECK(result.mad >= 0);
+}
+
+BENCH(TestYaffut,BenchAnEmptyOperation)
+{
+	yaffut::ClobberMemory();
+}
+
+TEST(TestYaffut,TestBenchesAreNotTests)
+{
+	CHECK(yaffut::Factory::Instance().IsBench("TestYaffut::BenchAnEmptyOperation"));
+	CHECK(!yaffut::Factory::Instance().IsBench("TestYaffut::TestBenchesAreNotTests"));
+}
+
+TEST(TestYaffut,TestDurationsArePrintedInTheirUnit)
+{
+	EQUAL("12.0 ns", yaffut::Duration(12));
+	EQUAL("1.5 us", yaffut::Duration(1500));
+	EQUAL("250.0 ms", yaffut::Duration(2.5e8));
+	EQUAL("3.0 s", yaffut::Duration(3e9));
+}
+
+TEST(TestYaffut,TestBaselineComparison)
+{
+	std::istringstream file(
+		"# test nanoseconds tolerance\n"
+		"Suite::Fast 100 10%\n"
+		"Suite::Slow 1000   # default tolerance\n"
+		"\n"
+		"Suite::Gone 50 5\n");
+	yaffut::Baseline baseline(20);
+	std::string error ;
+	CHECK(baseline.Read(file, error));
+	EQUAL(3u, baseline.Size());
+
+	yaffut::Baseline::Measured_t measured ;
+	measured["Suite::Fast"] = 111 ;
+	measured["Suite::Slow"] = 1100 ;
+	std::ostringstream table ;
+	EQUAL(1u, baseline.Compare(measured, table));
+	EQUAL("test           baseline    measured    change  tolerance\n"
+	      "Suite::Fast    100.0 ns    111.0 ns    +11.0%        10%  REGRESSED\n"
+	      "Suite::Gone     50.0 ns           -  not run\n"
+	      "Suite::Slow      1.0 us      1.1 us    +10.0%        20%\n", table.str());
+
+	std::ostringstream written ;
+	measured["Suite::New"] = 7 ;
+	baseline.Write(written, measured);
+	EQUAL("# test nanoseconds tolerance\n"
+	      "Suite::Fast 111 10%\n"
+	      "Suite::New 7 20%\n"
+	      "Suite::Slow 1100 20%\n", written.str());
+}
+
+TEST(TestYaffut,TestBaselineWithAMalformedLine)
+{
+	std::istringstream file("Suite::Fast 100\nSuite::Slow fast\n");
+	yaffut::Baseline baseline ;
+	std::string error ;
+	CHECK(!baseline.Read(file, error));
+	EQUAL("line 2: Suite::Slow fast", error);
+}
+
+TEST_BUDGET(TestYaffut,TestATestCanHaveATimeBudget,60000)
+{
+	EQUAL(60000u, yaffut::Factory::Instance().BudgetFor("TestYaffut::TestATestCanHaveATimeBudget"));
+	EQUAL(0u, yaffut::Factory::Instance().BudgetFor("TestYaffut::TestBaselineComparison"));
+}
+
+TEST(TestYaffut,TestCountersReportIpcAndMissRates)
+{
+	yaffut::Counters counters ;
+	std::ostringstream unavailable ;
+	unavailable << counters ;
+	EQUAL("counters unavailable", unavailable.str());
+
+	counters.value[yaffut::Counters::TaskClock] = 1500000 ;
+	counters.available[yaffut::Counters::TaskClock] = true ;
+	counters.value[yaffut::Counters::PageFaults] = 3 ;
+	counters.available[yaffut::Counters::PageFaults] = true ;
+	std::ostringstream software ;
+	software << counters ;
+	EQUAL("task clock 1500 us, 3 page faults", software.str());
+
+	const yaffut::Counters::Counter hardware[] = { yaffut::Counters::Cycles, yaffut::Counters::Instructions,
+		yaffut::Counters::Branches, yaffut::Counters::BranchMisses };
+	const double values[] = { 1000, 1500, 400, 10 };
+	for(int c = 0; c < 4; ++c)
+	{
+		counters.value[hardware[c]] = values[c] ;
+		counters.available[hardware[c]] = true ;
+	}
+	std::ostringstream rates ;
+	rates << counters ;
+	EQUAL("IPC 1.50, branch misses 2.50%", rates.str());
+}
+
+TEST(TestYaffut,TestCountedTestsCountWhatIsAllowed)
+{
+	yaffut::Counters counters ;
+	yaffut::Factory::RunCounted(&AllocatingTest, &counters);
+	if(counters.Has(yaffut::Counters::Instructions))
+	{
+		CHECK(counters.value[yaffut::Counters::Instructions] > 0);
+	}
+	if(counters.Has(yaffut::Counters::TaskClock))
+	{
+		CHECK(counters.value[yaffut::Counters::TaskClock] > 0);
+	}
+	yaffut::Counters watched ;
+	yaffut::Factory::RunWithWatchdog(&AllocatingTest, 1000, &watched);
+	EQUAL(counters.Has(yaffut::Counters::TaskClock), watched.Has(yaffut::Counters::TaskClock));
+}
@@ -0,0 +1,231 @@
+#ifndef TINYMOCKASYNC_H
+#define TINYMOCKASYNC_H
+
+/*
+Asynchronous results of mocked methods.
+
+An expectation still gives the value of a call; a DeterministicExecutor,
+driven by the test, delivers it later through a std::future or, with C++20
+coroutines, an awaitable. Nothing completes until the test runs the
+executor, which does so on the test's thread, in posting order, in an order
+picked by hand, or in a pseudo-random order reproduced from a seed.
+
+	class ReaderMock : public TinyMock::StaticMock<ReaderMock>
+	{
+	public:
+		ReaderMock(const std::string& className) : StaticMock<ReaderMock>(className), read(*this, "Read") {}
+		std::future<int> Read(int block) { return executor->Deliver(read(block)); }
+		TinyMock::StaticMethod<ReaderMock, int(int)> read ;
+		TinyMock::DeterministicExecutor* executor ;
+	};
+
+	reader->read.Expect(7).Returns(42);
+	std::future<int> result = client.Load(7);
+	executor.RunUntilIdle();
+*/
+
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <stdexcept>
+
+#if defined(__cpp_impl_coroutine)
+#include <coroutine>
+#include <optional>
+#endif
+
+#include "TinyMock.h"
+
+namespace TinyMock {
+
+class DeterministicExecutor
+{
+public:
+	typedef std::function<void()> Task ;
+
+	DeterministicExecutor() : m_shuffled(false), m_state(0) {}
+
+	void Post(const Task& task)
+	{
+		m_tasks.push_back(task);
+	}
+	size_t Pending() const
+	{
+		return m_tasks.size();
+	}
+
+	// Tasks run in the order they were posted; this is the default.
+	void InOrder()
+	{
+		m_shuffled = false ;
+	}
+	// Tasks run in a pseudo-random order that is the same for the same seed
+	// and the same tasks.
+	void Shuffle(unsigned long long seed)
+	{
+		m_shuffled = true ;
+		m_state = seed ;
+	}
+
+	// Runs the next task; false when there is none.
+	bool RunOne()
+	{
+		if(m_tasks.empty())
+		{
+			return false ;
+		}
+		if(m_shuffled)
+		{
+			std::swap(m_tasks.front(), m_tasks[Next() % m_tasks.size()]);
+		}
+		RunAt(0);
+		return true ;
+	}
+	// Runs the i-th pending task in posting order, for completing calls out
+	// of order by hand; throws std::out_of_range when there is none.
+	void RunAt(size_t i)
+	{
+		if(i >= m_tasks.size())
+		{
+			throw std::out_of_range("DeterministicExecutor::RunAt: no such pending task");
+		}
+		Task task ;
+		task.swap(m_tasks[i]);
+		m_tasks.erase(m_tasks.begin() + i);
+		task();
+	}
+	// Runs tasks, including those posted meanwhile, until none is left;
+	// returns how many ran.
+	size_t RunUntilIdle()
+	{
+		size_t ran = 0 ;
+		while(RunOne())
+		{
+			++ran ;
+		}
+		return ran ;
+	}
+
+	// A future that gets 'value' when the executor gets to it.
+	template <typename R>
+	std::future<R> Deliver(const R& value)
+	{
+		std::shared_ptr<std::promise<R> > promise(new std::promise<R>());
+		Post([promise, value]() { promise->set_value(value); });
+		return promise->get_future();
+	}
+	std::future<void> Deliver()
+	{
+		std::shared_ptr<std::promise<void> > promise(new std::promise<void>());
+		Post([promise]() { promise->set_value(); });
+		return promise->get_future();
+	}
+	// A future that gets 'failure' when the executor gets to it.
+	template <typename R>
+	std::future<R> Fail(std::exception_ptr failure)
+	{
+		std::shared_ptr<std::promise<R> > promise(new std::promise<R>());
+		Post([promise, failure]() { promise->set_exception(failure); });
+		return promise->get_future();
+	}
+
+#if defined(__cpp_impl_coroutine)
+	template <typename R>
+	class Awaitable ;
+
+	// co_await on the result suspends the coroutine until the executor
+	// gets to it.
+	template <typename R>
+	Awaitable<R> Await(const R& value)
+	{
+		return Awaitable<R>(*this, value);
+	}
+	Awaitable<void> Await() ;
+	template <typename R>
+	Awaitable<R> AwaitFailure(std::exception_ptr failure)
+	{
+		return Awaitable<R>(*this, failure);
+	}
+#endif
+
+private:
+	std::deque<Task> m_tasks ;
+	bool m_shuffled ;
+	unsigned long long m_state ;
+
+	// splitmix64
+	unsigned long long Next()
+	{
+		unsigned long long z = (m_state += 0x9E3779B97F4A7C15ULL);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL ;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL ;
+		return z ^ (z >> 31);
+	}
+};
+
+#if defined(__cpp_impl_coroutine)
+// What Awaitable does for every result type: resumes on the executor and
+// throws the failure, if any.
+class AwaitableBase
+{
+public:
+	bool await_ready() const
+	{
+		return false ;
+	}
+	void await_suspend(std::coroutine_handle<> coroutine)
+	{
+		m_executor.Post([coroutine]() { coroutine.resume(); });
+	}
+protected:
+	AwaitableBase(DeterministicExecutor& executor, std::exception_ptr failure) : m_executor(executor), m_failure(failure) {}
+	void Rethrow() const
+	{
+		if(m_failure)
+		{
+			std::rethrow_exception(m_failure);
+		}
+	}
+private:
+	DeterministicExecutor& m_executor ;
+	std::exception_ptr m_failure ;
+};
+
+// Holds no value when it fails, so R need not be default-constructible.
+template <typename R>
+class DeterministicExecutor::Awaitable : public AwaitableBase
+{
+public:
+	Awaitable(DeterministicExecutor& executor, const R& value) : AwaitableBase(executor, std::exception_ptr()), m_value(value) {}
+	Awaitable(DeterministicExecutor& executor, std::exception_ptr failure) : AwaitableBase(executor, failure) {}
+	R await_resume()
+	{
+		Rethrow();
+		return std::move(*m_value);
+	}
+private:
+	std::optional<R> m_value ;
+};
+
+template <>
+class DeterministicExecutor::Awaitable<void> : public AwaitableBase
+{
+public:
+	Awaitable(DeterministicExecutor& executor, std::exception_ptr failure = std::exception_ptr()) : AwaitableBase(executor, failure) {}
+	void await_resume()
+	{
+		Rethrow();
+	}
+};
+
+inline DeterministicExecutor::Awaitable<void> DeterministicExecutor::Await()
+{
+	return Awaitable<void>(*this);
+}
+#endif
+
+}
+
+#endif
@@ -0,0 +1,167 @@
+#ifndef TINYMOCKCLOCK_H
+#define TINYMOCKCLOCK_H
+
+/*
+Time as a dependency.
+
+Code that waits, retries or times out takes a Clock; production passes a
+SystemClock, tests a VirtualClock, where time only moves when the test or a
+mocked call moves it. Sleeping on a virtual clock returns at once with the
+time advanced, so backoffs of minutes take no wall-clock time.
+
+An expectation can stand for a slow call: Delay() gives a notifier that
+advances the clock when the call is matched.
+
+	TinyMock::VirtualClock clock ;
+	mock->RegisterExpectation(new Method<...>("Connect",...)).AddNotifier(clock.Delay(std::chrono::seconds(2)));
+	clock.Schedule(std::chrono::seconds(1), [&]() { timedOut = true; });
+*/
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "TinyMock.h"
+
+namespace TinyMock {
+
+class Clock
+{
+public:
+	typedef std::chrono::nanoseconds Duration ;
+	virtual ~Clock() {}
+	// Time since an arbitrary epoch that does not change.
+	virtual Duration Now() const = 0;
+	virtual void SleepFor(Duration duration) = 0;
+};
+
+class SystemClock : public Clock
+{
+public:
+	Duration Now() const
+	{
+		return std::chrono::duration_cast<Duration>(std::chrono::steady_clock::now().time_since_epoch());
+	}
+	void SleepFor(Duration duration)
+	{
+		std::this_thread::sleep_for(duration);
+	}
+};
+
+// A clock that starts at zero and moves only when told to. Timers run on the
+// thread that moves the clock, in the order they are due; timers due at the
+// same time run in the order they were scheduled.
+class VirtualClock : public Clock
+{
+public:
+	typedef std::function<void()> Task ;
+
+	VirtualClock() : m_now(0), m_scheduled(0) {}
+
+	Duration Now() const
+	{
+		return m_now ;
+	}
+	// Returns at once, with the time and the timers due meanwhile gone by.
+	void SleepFor(Duration duration)
+	{
+		AdvanceBy(duration);
+	}
+
+	void Schedule(Duration delay, const Task& task)
+	{
+		Timer timer = { m_now + delay, m_scheduled++, task };
+		m_timers.push(timer);
+	}
+	size_t Pending() const
+	{
+		return m_timers.size();
+	}
+
+	void AdvanceBy(Duration duration)
+	{
+		AdvanceTo(m_now + duration);
+	}
+	void AdvanceTo(Duration time)
+	{
+		while(!m_timers.empty() && m_timers.top().due <= time)
+		{
+			RunNextTimer();
+		}
+		if(m_now < time)
+		{
+			m_now = time ;
+		}
+	}
+	// Moves from timer to timer, including timers scheduled meanwhile, until
+	// none is left; returns how many ran.
+	size_t RunUntilIdle()
+	{
+		size_t ran = 0 ;
+		while(!m_timers.empty())
+		{
+			RunNextTimer();
+			++ran ;
+		}
+		return ran ;
+	}
+
+	// A notifier that advances the clock by 'duration' when sent; add it to
+	// an expectation to make the matching call take that long. It lives as
+	// long as the clock.
+	TinyNotifier* Delay(Duration duration)
+	{
+		m_delays.push_back(std::unique_ptr<TinyNotifier>(new ClockDelay(*this, duration)));
+		return m_delays.back().get();
+	}
+
+private:
+	struct Timer
+	{
+		Duration due ;
+		unsigned long long order ;
+		Task task ;
+	};
+	struct Later
+	{
+		bool operator()(const Timer& lhs, const Timer& rhs) const
+		{
+			return lhs.due != rhs.due ? lhs.due > rhs.due : lhs.order > rhs.order ;
+		}
+	};
+	class ClockDelay : public TinyNotifier
+	{
+	public:
+		ClockDelay(VirtualClock& clock, Duration duration) : m_clock(clock), m_duration(duration) {}
+		void Send(bool = true)
+		{
+			m_clock.AdvanceBy(m_duration);
+		}
+	private:
+		VirtualClock& m_clock ;
+		Duration m_duration ;
+	};
+
+	Duration m_now ;
+	unsigned long long m_scheduled ;
+	std::priority_queue<Timer, std::vector<Timer>, Later> m_timers ;
+	std::vector<std::unique_ptr<TinyNotifier> > m_delays ;
+
+	void RunNextTimer()
+	{
+		Timer timer = m_timers.top();
+		m_timers.pop();
+		if(m_now < timer.due)
+		{
+			m_now = timer.due ;
+		}
+		timer.task();
+	}
+};
+
+}
+
+#endif
@@ -0,0 +1,1715 @@
+#ifndef TINYMOCKCORE_H
+#define TINYMOCKCORE_H
+
+/*
+The MIT License
+Copyright (c) 2009 Marcin Czenko
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Expectations, mocks and repositories: everything a mocked call goes
+// through. Only stream declarations are needed here; what prints to a stream
+// is defined in TinyMockImpl.h.
+
+#include <assert.h>
+#include <algorithm>
+#include <cmath>
+#include <iosfwd>
+#include <vector>
+#include <map>
+#include <string>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <typeindex>
+#include <typeinfo>
+#include <utility>
+
+// Marks the definitions in TinyMockImpl.h: inline when they are compiled
+// into every translation unit, external in the TinyMock library.
+#ifndef TINYMOCK_INLINE
+#ifdef TINYMOCK_LEAN
+#define TINYMOCK_INLINE
+#else
+#define TINYMOCK_INLINE inline
+#endif
+#endif
+
+namespace TinyMock {
+
+class IgnoredMethodsContainer
+{
+public:
+	IgnoredMethodsContainer() : IGNORE_ALL(-1) {}
+	void ignoreAll(const std::string& methodName)
+	{
+		m_ignoredMethods[methodName] = IGNORE_ALL ;
+	}
+
+	bool isIgnored(const std::string& methodName)
+	{
+		return m_ignoredMethods.find(methodName)!=m_ignoredMethods.end() ;
+	}
+
+	void clear()
+	{
+		m_ignoredMethods.clear();
+	}
+
+private:
+	const int IGNORE_ALL ;
+	std::map<std::string,int> m_ignoredMethods;
+};
+
+class TinyNotifier
+{
+public:
+	virtual ~TinyNotifier() {}
+	virtual void Send(bool status=true) {}
+};
+
+// Orders expectations across mocks and threads. Each expectation registered
+// in a sequence takes the next position; a call is in order when no position
+// before its own is still waiting. Checking a call costs one atomic
+// compare-and-swap on the position the sequence is at.
+class Sequence
+{
+public:
+	Sequence() : m_next(0) {}
+	// 'call' describes the expected call for reports.
+	size_t Enlist(const std::string& call)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_calls.push_back(call);
+		return m_calls.size() - 1 ;
+	}
+	// Moves the sequence past 'position'. False when that skips positions;
+	// 'skipped' is then the first of them. A call that comes after the
+	// sequence moved past it was reported when it was skipped, so it is let
+	// through.
+	bool Advance(size_t position, size_t& skipped)
+	{
+		size_t next = m_next.load();
+		while(next <= position)
+		{
+			if(m_next.compare_exchange_weak(next, position + 1))
+			{
+				skipped = next ;
+				return next == position ;
+			}
+		}
+		return true ;
+	}
+	std::string Call(size_t position) const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_calls[position];
+	}
+	size_t Position() const
+	{
+		return m_next.load();
+	}
+	size_t Size() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_calls.size();
+	}
+private:
+	std::atomic<size_t> m_next ;
+	mutable std::mutex m_mutex ;
+	std::vector<std::string> m_calls ;
+};
+
+class BaseMethod;
+
+// Takes back expectations that were not allocated one by one, see
+// BaseMethod::Release().
+class MethodRecycler
+{
+public:
+	virtual ~MethodRecycler() {}
+	virtual void Recycle(BaseMethod* method) = 0;
+};
+
+// What the shared formatting code needs to know about a Method type: its
+// return and parameter types, how to print each argument and where to find
+// it. There is one constant table per type, see TinyMockMethods.h.
+struct MethodDescriptor
+{
+	typedef void (*Format)(std::ostream& os, const void* value);
+	typedef const void* (*Argument)(const BaseMethod& method, size_t index);
+
+	const std::type_info* result ;
+	bool anyArguments ;
+	size_t arity ;
+	const std::type_info* parameters[4] ;
+	Format formats[4] ;
+	Argument argument ;
+};
+
+class BaseMethod
+{
+public:	
+	BaseMethod(const std::string& methodName="", const MethodDescriptor* descriptor=NULL) : m_mockNotifier(NULL), m_externalMockNotifier(NULL), m_name(methodName), m_ignoreArguments(false), m_recycler(NULL), m_sequence(NULL), m_position(0), m_descriptor(descriptor) {}
+
+	virtual ~BaseMethod()
+	{
+		delete m_mockNotifier;
+	}
+
+	virtual bool operator==(const BaseMethod& op)
+	{
+		return true ;
+	}
+
+	// Both are made from the descriptor, if there is one.
+	virtual std::string Signature() ;
+	virtual std::string ToString() ;
+
+	// Where the index-th argument of a method is; Method types with
+	// arguments hide this.
+	static const void* Argument(const BaseMethod&, size_t)
+	{
+		return NULL ;
+	}
+
+	template<typename N>
+	BaseMethod& AddNotifier()
+	{
+		m_mockNotifier = new N();
+		return *this ;
+	}	
+
+	BaseMethod& AddNotifier(TinyNotifier * mockNotifier)
+	{
+		m_externalMockNotifier = mockNotifier;
+		return *this ;
+	}
+
+	BaseMethod& ignoreArguments()
+	{
+		m_ignoreArguments = true ;
+		return *this ;
+	}	
+
+	virtual void ExecuteMockNotifier()
+	{
+		if(m_mockNotifier)
+		{
+			m_mockNotifier->Send();
+			return;
+		}
+		if(m_externalMockNotifier)
+		{
+			m_externalMockNotifier->Send();			
+		}
+	}
+
+	virtual std::string GetName()
+	{
+		return m_name;
+	}
+
+	const std::string& Name() const
+	{
+		return m_name;
+	}
+
+	void RecycleWith(MethodRecycler* recycler)
+	{
+		m_recycler = recycler ;
+	}
+
+	void PlaceInSequence(Sequence* sequence, size_t position)
+	{
+		m_sequence = sequence ;
+		m_position = position ;
+	}
+
+	Sequence* InSequence() const
+	{
+		return m_sequence ;
+	}
+
+	size_t PositionInSequence() const
+	{
+		return m_position ;
+	}
+
+	// Disposes of a consumed expectation: deletes it, or hands it back to
+	// the recycler it came from.
+	void Release()
+	{
+		if(m_recycler)
+		{
+			m_recycler->Recycle(this);
+			return;
+		}
+		delete this;
+	}
+
+protected:
+	TinyNotifier* m_mockNotifier ;
+	TinyNotifier* m_externalMockNotifier;
+	std::string m_name ;
+	bool m_ignoreArguments;
+	MethodRecycler* m_recycler ;
+	Sequence* m_sequence ;
+	size_t m_position ;
+	const MethodDescriptor* m_descriptor ;
+};
+
+class ExpectationViolationException {};
+
+class MockPrinter
+{
+public:
+    static bool& Silent()
+    {
+        static bool silent = false ;
+        return silent ;
+    }
+	static void Silent(bool silent)
+    {
+        bool& lsilent = Silent();
+        lsilent = silent ;
+    }
+};
+
+// FIFO on a ring buffer that only ever grows, so a steady flow of entries
+// through it does not allocate.
+template <typename T>
+class RingQueue
+{
+public:
+	RingQueue() : m_head(0), m_size(0) {}
+	void push_back(const T& entry)
+	{
+		if(m_size == m_slots.size())
+		{
+			Grow();
+		}
+		m_slots[(m_head + m_size) % m_slots.size()] = entry ;
+		++m_size ;
+	}
+	T& front()
+	{
+		return m_slots[m_head];
+	}
+	T& back()
+	{
+		return (*this)[m_size - 1];
+	}
+	void pop_front()
+	{
+		m_head = (m_head + 1) % m_slots.size();
+		--m_size ;
+	}
+	T& operator[](size_t i)
+	{
+		return m_slots[(m_head + i) % m_slots.size()];
+	}
+	const T& operator[](size_t i) const
+	{
+		return m_slots[(m_head + i) % m_slots.size()];
+	}
+	size_t size() const
+	{
+		return m_size ;
+	}
+	bool empty() const
+	{
+		return m_size == 0 ;
+	}
+	void clear()
+	{
+		m_head = 0 ;
+		m_size = 0 ;
+	}
+private:
+	std::vector<T> m_slots ;
+	size_t m_head ;
+	size_t m_size ;
+
+	void Grow()
+	{
+		std::vector<T> slots(m_slots.empty() ? 8 : 2 * m_slots.size());
+		for(size_t i = 0; i < m_size; ++i)
+		{
+			slots[i] = (*this)[i];
+		}
+		m_slots.swap(slots);
+		m_head = 0 ;
+	}
+};
+
+// The expectations for one signature.
+typedef RingQueue<BaseMethod*> ExpectationQueue ;
+
+class Expectations;
+
+// Expectations kept outside of the signature map, e.g. the typed queue of a
+// StaticMethod. Expectations reports and clears them along with its own; the
+// source only has to keep its count in step through Registered() and
+// Consumed(). The pending expectations of a source count as outstanding from
+// the moment it is added.
+class ExpectationSource
+{
+public:
+	virtual ~ExpectationSource() {}
+	// Called when a call of 'signature' finds no expectation: a source that
+	// makes its expectations on demand hands them over through
+	// Expectations::Materialise(), and returns true once it has handed over
+	// one for 'signature'.
+	virtual bool Supply(const std::string&, Expectations&)
+	{
+		return false ;
+	}
+	virtual size_t Pending() const = 0;
+	virtual std::string Signature() const = 0;
+	virtual void PrintPending(std::ostream& os, const std::string& className) const = 0;
+	// Drops the pending expectations.
+	virtual void Clear() = 0;
+};
+
+// Keeps a running count of the expectations outstanding in all the mocks of
+// a repository, and the list of mocks that got any since they were last
+// verified, so that verifying satisfied mocks does not have to walk them.
+class ExpectationTracker
+{
+public:
+	ExpectationTracker() : m_outstanding(0) {}
+	void Registered(size_t count)
+	{
+		m_outstanding += count ;
+	}
+	void Consumed(size_t count)
+	{
+		m_outstanding -= count ;
+	}
+	void MarkDirty(Expectations* expectations)
+	{
+		m_dirty.push_back(expectations);
+	}
+	size_t Outstanding() const
+	{
+		return m_outstanding ;
+	}
+	std::vector<Expectations*>& Dirty()
+	{
+		return m_dirty ;
+	}
+private:
+	size_t m_outstanding ;
+	std::vector<Expectations*> m_dirty ;
+};
+
+class Expectations
+{
+public:	
+    Expectations() : m_tracker(NULL), m_outstanding(0), m_dirty(false) {}
+    Expectations(const std::string& className) : m_className(className), m_tracker(NULL), m_outstanding(0), m_dirty(false) {}
+	~Expectations()
+	{
+		//UnhandledExpectations();		
+	}
+	void Track(ExpectationTracker* tracker)
+	{
+		m_tracker = tracker ;
+		if(m_outstanding)
+		{
+			m_tracker->Registered(m_outstanding);
+			MarkDirty();
+		}
+	}
+        TinyMock::BaseMethod& AddExpectationFor(const std::string& signature, TinyMock::BaseMethod* expectation)
+	{
+		m_methods[signature].push_back(expectation);
+		Registered();
+		return *expectation ;
+	}
+        TinyMock::BaseMethod* GetFirstExpectationFor(const std::string& signature)
+	{
+                TinyMock::BaseMethod* ret = 0 ;
+		if(!m_sources.empty() && IsEmpty(signature))
+		{
+			Supply(signature);
+		}
+		if(!IsEmpty(signature))
+		{
+			ret = m_methods[signature].front();
+			m_methods[signature].pop_front();
+			Consumed(1);
+		}
+		return ret ;
+	}
+	size_t Outstanding() const
+	{
+		return m_outstanding ;
+	}
+	bool Dirty() const
+	{
+		return m_dirty ;
+	}
+	void Clean()
+	{
+		m_dirty = false ;
+	}
+	const std::string& ClassName() const
+	{
+		return m_className ;
+	}
+	void Rename(const std::string& className)
+	{
+		m_className = className ;
+	}
+	void AddSource(ExpectationSource* source)
+	{
+		m_sources.push_back(source);
+		if(source->Pending())
+		{
+			Registered(source->Pending());
+		}
+	}
+	// Takes over an expectation that a source counted as pending until now.
+	void Materialise(const std::string& signature, TinyMock::BaseMethod* expectation)
+	{
+		m_methods[signature].push_back(expectation);
+	}
+	bool IsEmpty(const std::string& signature)
+	{
+		return (m_methods[signature].size()==0);
+	}
+	bool UnhandledExpectations()
+	{
+		bool failed = false ;
+		if(m_methods.size() != 0)
+		{			
+                        typedef std::map<std::string,TinyMock::ExpectationQueue>::iterator I ;
+			for(I m = m_methods.begin() ; m != m_methods.end(); ++m)
+			{
+				std::string signature = m->first;
+                                TinyMock::ExpectationQueue& deque = m->second;
+				if(deque.size())
+				{
+					failed = true ;
+					PrintExpectations(signature,deque);
+				}
+			}			
+		}
+		for(size_t s = 0; s < m_sources.size(); ++s)
+		{
+			if(m_sources[s]->Pending())
+			{
+				failed = true ;
+				PrintExpectations(*m_sources[s]);
+			}
+		}
+		return failed ;
+	}
+	// Unlike UnhandledExpectations() this leaves the expectations in place.
+	void PrintPendingExpectations(std::ostream& os) ;
+	// Drops all the expectations without reporting them.
+	void Clear()
+	{
+		typedef std::map<std::string,TinyMock::ExpectationQueue>::iterator I ;
+		for(I m = m_methods.begin() ; m != m_methods.end(); ++m)
+		{
+			Consumed(m->second.size());
+			while(m->second.size())
+			{
+				m->second.front()->Release();
+				m->second.pop_front();
+			}
+		}
+		for(size_t s = 0; s < m_sources.size(); ++s)
+		{
+			Consumed(m_sources[s]->Pending());
+			m_sources[s]->Clear();
+		}
+	}
+	// Drops the expectations of one method, leaving those of sources alone.
+	void Clear(const std::string& signature)
+	{
+		std::map<std::string,TinyMock::ExpectationQueue>::iterator m = m_methods.find(signature);
+		if(m == m_methods.end())
+		{
+			return ;
+		}
+		Consumed(m->second.size());
+		while(m->second.size())
+		{
+			m->second.front()->Release();
+			m->second.pop_front();
+		}
+	}
+        void PrintExpectations(const std::string & signature, TinyMock::ExpectationQueue & deque) ;
+	void PrintExpectations(ExpectationSource& source) ;
+
+	void Registered(size_t count = 1)
+	{
+		m_outstanding += count ;
+		if(m_tracker)
+		{
+			m_tracker->Registered(count);
+			MarkDirty();
+		}
+	}
+	void Consumed(size_t count)
+	{
+		m_outstanding -= count ;
+		if(m_tracker)
+		{
+			m_tracker->Consumed(count);
+		}
+	}
+
+private:
+        std::map<std::string,TinyMock::ExpectationQueue> m_methods;
+	std::vector<ExpectationSource*> m_sources ;
+    std::string m_className ;
+	ExpectationTracker* m_tracker ;
+	size_t m_outstanding ;
+	bool m_dirty ;
+
+	void Supply(const std::string& signature)
+	{
+		for(size_t s = 0; s < m_sources.size(); ++s)
+		{
+			if(m_sources[s]->Supply(signature, *this))
+			{
+				return ;
+			}
+		}
+	}
+	void MarkDirty()
+	{
+		if(!m_dirty)
+		{
+			m_dirty = true ;
+			m_tracker->MarkDirty(this);
+		}
+	}
+};
+
+inline bool ByClassName(const Expectations* lhs, const Expectations* rhs)
+{
+	return lhs->ClassName() < rhs->ClassName();
+}
+
+// Identifies a mocked method for stubbing by its name and result type, so
+// that methods of the same name returning different types do not share a
+// stub. Make it a function-local static in the mocked method, so the method
+// is looked up once and checking for a stub costs an index comparison.
+class StubId
+{
+public:
+	StubId(const std::string& methodName, const std::type_info& result) : m_index(IndexOf(methodName, result)), m_result(&result) {}
+	size_t Index() const
+	{
+		return m_index ;
+	}
+	const std::type_info& Result() const
+	{
+		return *m_result ;
+	}
+	static size_t IndexOf(const std::string& methodName, const std::type_info& result)
+	{
+		typedef std::pair<std::string,std::type_index> Key ;
+		static std::mutex mutex ;
+		static std::map<Key,size_t> indices ;
+		std::lock_guard<std::mutex> lock(mutex);
+		return indices.insert(std::make_pair(Key(methodName, std::type_index(result)), indices.size())).first->second ;
+	}
+private:
+	size_t m_index ;
+	const std::type_info* m_result ;
+};
+
+class StubActionBase
+{
+public:
+	virtual ~StubActionBase() {}
+};
+
+// What a stubbed method does instead of checking expectations: return a
+// constant, return values from a sequence in turn, or call a functor. The
+// choice is made when the stub is set up; serving a call neither branches on
+// it nor allocates.
+template <typename R>
+class StubAction : public StubActionBase
+{
+public:
+	StubAction() : m_next(&StubAction::Constant), m_value(), m_position(0) {}
+	StubAction& Returns(const R& value)
+	{
+		m_value = value ;
+		m_next = &StubAction::Constant ;
+		return *this ;
+	}
+	StubAction& ReturnsInTurn(const std::vector<R>& values)
+	{
+		assert(!values.empty());
+		m_sequence = values ;
+		m_position = 0 ;
+		m_next = &StubAction::InTurn ;
+		return *this ;
+	}
+	StubAction& Calls(const std::function<R()>& functor)
+	{
+		m_functor = functor ;
+		m_next = &StubAction::Call ;
+		return *this ;
+	}
+	R Next()
+	{
+		return (this->*m_next)();
+	}
+private:
+	R (StubAction::*m_next)();
+	R m_value ;
+	std::vector<R> m_sequence ;
+	size_t m_position ;
+	std::function<R()> m_functor ;
+
+	R Constant()
+	{
+		return m_value ;
+	}
+	R InTurn()
+	{
+		const size_t position = m_position ;
+		m_position = position + 1 == m_sequence.size() ? 0 : position + 1 ;
+		return m_sequence[position];
+	}
+	R Call()
+	{
+		return m_functor();
+	}
+};
+
+template <>
+class StubAction<void> : public StubActionBase
+{
+public:
+	StubAction& Calls(const std::function<void()>& functor)
+	{
+		m_functor = functor ;
+		return *this ;
+	}
+	void Next()
+	{
+		if(m_functor)
+		{
+			m_functor();
+		}
+	}
+private:
+	std::function<void()> m_functor ;
+};
+
+struct Violation
+{
+	enum Kind { NotExpected, ExpectedAndActualDifferent, OutOfOrder };
+	Kind kind ;
+	std::string mockName ;
+	std::string expected ;
+	std::string actual ;
+};
+
+// Takes the violations of a ViolationLog forwarding to it.
+class ViolationSink
+{
+public:
+	virtual ~ViolationSink() {}
+	virtual void Append(Violation::Kind kind, const std::string& mockName, const std::string& expected, const std::string& actual) = 0;
+};
+
+// Violations recorded instead of being reported one by one. The slots are
+// allocated up front and reused after Clear(); violations beyond the
+// capacity are only counted.
+class ViolationLog
+{
+public:
+	ViolationLog() : m_size(0), m_dropped(0), m_sink(NULL) {}
+	// Hands the violations to 'sink' instead of recording them.
+	void ForwardTo(ViolationSink* sink)
+	{
+		m_sink = sink ;
+	}
+	void Reserve(size_t capacity)
+	{
+		m_violations.resize(capacity);
+		Clear();
+	}
+	void Append(Violation::Kind kind, const std::string& mockName, const std::string& expected, const std::string& actual)
+	{
+		if(m_sink)
+		{
+			m_sink->Append(kind, mockName, expected, actual);
+			return ;
+		}
+		if(m_size == m_violations.size())
+		{
+			++m_dropped ;
+			return ;
+		}
+		Violation& violation = m_violations[m_size++];
+		violation.kind = kind ;
+		violation.mockName.assign(mockName);
+		violation.expected.assign(expected);
+		violation.actual.assign(actual);
+	}
+	size_t Size() const
+	{
+		return m_size ;
+	}
+	size_t Dropped() const
+	{
+		return m_dropped ;
+	}
+	bool IsEmpty() const
+	{
+		return m_size == 0 && m_dropped == 0 ;
+	}
+	const Violation& operator[](size_t i) const
+	{
+		return m_violations[i];
+	}
+	void Clear()
+	{
+		m_size = 0 ;
+		m_dropped = 0 ;
+	}
+	void Print(std::ostream& os) const ;
+	// Prints to std::cout unless MockPrinter is silent.
+	void Report() const ;
+private:
+	std::vector<Violation> m_violations ;
+	size_t m_size ;
+	size_t m_dropped ;
+	ViolationSink* m_sink ;
+};
+
+typedef unsigned long long (*TimeSource)();
+
+inline unsigned long long SteadyNanoseconds()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Calls of one mocked method and a histogram of the times between them, in
+// nanoseconds. The buckets are log-scaled with four sub-buckets per power of
+// two, so a bucket is at most 25% wide; recording is a few relaxed atomic
+// operations.
+class MethodStatistics
+{
+public:
+	enum { Buckets = 252 };
+	// m_last before the first call; a time source may well start at 0.
+	static const unsigned long long NoCall = ~0ULL ;
+
+	MethodStatistics() : m_key(0), m_calls(0), m_last(NoCall), m_sum(0)
+	{
+		Clear();
+	}
+
+	const std::string& Name() const
+	{
+		return m_name ;
+	}
+	unsigned long long Calls() const
+	{
+		return m_calls.load(std::memory_order_relaxed);
+	}
+	unsigned long long Intervals() const
+	{
+		const unsigned long long calls = Calls();
+		return calls ? calls - 1 : 0 ;
+	}
+	double Mean() const
+	{
+		return Intervals() ? double(m_sum.load(std::memory_order_relaxed)) / Intervals() : 0.0 ;
+	}
+	// The time between calls that 'percent' of the intervals do not exceed,
+	// rounded up to the end of its bucket.
+	unsigned long long Percentile(double percent) const
+	{
+		const unsigned long long intervals = Intervals();
+		if(intervals == 0)
+		{
+			return 0 ;
+		}
+		unsigned long long rank = static_cast<unsigned long long>(percent / 100.0 * intervals + 0.5);
+		rank = rank < 1 ? 1 : rank > intervals ? intervals : rank ;
+		unsigned long long seen = 0 ;
+		for(size_t b = 0; b < Buckets; ++b)
+		{
+			seen += m_buckets[b].load(std::memory_order_relaxed);
+			if(seen >= rank)
+			{
+				return UpperBound(b);
+			}
+		}
+		return UpperBound(Buckets - 1);
+	}
+	// The coefficient of variation of the intervals, estimated from the
+	// histogram: about 0 for calls at a steady rate, about 1 for random
+	// arrivals, above 1 for bursts.
+	double Burstiness() const
+	{
+		const double mean = Mean();
+		if(mean == 0.0)
+		{
+			return 0.0 ;
+		}
+		double squares = 0.0 ;
+		unsigned long long counted = 0 ;
+		for(size_t b = 0; b < Buckets; ++b)
+		{
+			const unsigned long long count = m_buckets[b].load(std::memory_order_relaxed);
+			const double middle = (double(LowerBound(b)) + double(UpperBound(b))) / 2 - mean ;
+			squares += count * middle * middle ;
+			counted += count ;
+		}
+		return counted ? std::sqrt(squares / counted) / mean : 0.0 ;
+	}
+
+	void Record(unsigned long long now)
+	{
+		m_calls.fetch_add(1, std::memory_order_relaxed);
+		const unsigned long long previous = m_last.exchange(now, std::memory_order_relaxed);
+		if(previous != NoCall)
+		{
+			const unsigned long long interval = now > previous ? now - previous : 0 ;
+			m_buckets[BucketOf(interval)].fetch_add(1, std::memory_order_relaxed);
+			m_sum.fetch_add(interval, std::memory_order_relaxed);
+		}
+	}
+	void Clear()
+	{
+		m_calls.store(0);
+		m_last.store(NoCall);
+		m_sum.store(0);
+		for(size_t b = 0; b < Buckets; ++b)
+		{
+			m_buckets[b].store(0);
+		}
+	}
+
+	static size_t BucketOf(unsigned long long value)
+	{
+		if(value < 4)
+		{
+			return static_cast<size_t>(value);
+		}
+		const int msb = 63 - __builtin_clzll(value);
+		return (msb - 1) * 4 + ((value >> (msb - 2)) & 3);
+	}
+	static unsigned long long LowerBound(size_t bucket)
+	{
+		if(bucket < 4)
+		{
+			return bucket ;
+		}
+		return (4ULL + bucket % 4) << (bucket / 4 - 1);
+	}
+	static unsigned long long UpperBound(size_t bucket)
+	{
+		if(bucket < 4)
+		{
+			return bucket ;
+		}
+		return ((5ULL + bucket % 4) << (bucket / 4 - 1)) - 1 ;
+	}
+
+private:
+	friend class CallStatistics ;
+	std::atomic<unsigned long long> m_key ;
+	std::string m_name ;
+	std::atomic<unsigned long long> m_calls ;
+	std::atomic<unsigned long long> m_last ;
+	std::atomic<unsigned long long> m_sum ;
+	std::atomic<unsigned long long> m_buckets[Buckets];
+};
+
+// The MethodStatistics of the methods of one mock, in a table of fixed size
+// that methods take their places in, by the hash of their name, without
+// locking. Calls of methods beyond its capacity are only counted.
+class CallStatistics
+{
+public:
+	enum { Capacity = 32 };
+
+	CallStatistics(TimeSource now = &SteadyNanoseconds) : m_now(now), m_dropped(0) {}
+
+	void Record(const std::string& methodName)
+	{
+		if(MethodStatistics* method = Place(methodName))
+		{
+			method->Record(m_now());
+		}
+		else
+		{
+			m_dropped.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+	// NULL for a method that was never called.
+	const MethodStatistics* Find(const std::string& methodName) const
+	{
+		const unsigned long long key = KeyOf(methodName);
+		for(size_t probe = 0; probe < Capacity; ++probe)
+		{
+			const MethodStatistics& method = m_methods[(key + probe) % Capacity];
+			const unsigned long long placed = method.m_key.load(std::memory_order_acquire);
+			if(placed == key)
+			{
+				return &method ;
+			}
+			if(placed == 0)
+			{
+				return NULL ;
+			}
+		}
+		return NULL ;
+	}
+	// The methods called so far, in no particular order.
+	std::vector<const MethodStatistics*> Methods() const
+	{
+		std::vector<const MethodStatistics*> methods ;
+		for(size_t m = 0; m < Capacity; ++m)
+		{
+			if(m_methods[m].m_key.load(std::memory_order_acquire) != 0)
+			{
+				methods.push_back(&m_methods[m]);
+			}
+		}
+		return methods ;
+	}
+	unsigned long long Dropped() const
+	{
+		return m_dropped.load(std::memory_order_relaxed);
+	}
+	void Clear()
+	{
+		for(size_t m = 0; m < Capacity; ++m)
+		{
+			m_methods[m].Clear();
+		}
+		m_dropped.store(0);
+	}
+	void Print(std::ostream& os, const std::string& className) const ;
+
+private:
+	TimeSource m_now ;
+	MethodStatistics m_methods[Capacity];
+	std::atomic<unsigned long long> m_dropped ;
+
+	// FNV-1a, never 0, which marks a free place.
+	static unsigned long long KeyOf(const std::string& methodName)
+	{
+		unsigned long long hash = 14695981039346656037ULL ;
+		for(size_t i = 0; i < methodName.size(); ++i)
+		{
+			hash = (hash ^ static_cast<unsigned char>(methodName[i])) * 1099511628211ULL ;
+		}
+		return hash ? hash : 1 ;
+	}
+	MethodStatistics* Place(const std::string& methodName)
+	{
+		const unsigned long long key = KeyOf(methodName);
+		for(size_t probe = 0; probe < Capacity; ++probe)
+		{
+			MethodStatistics& method = m_methods[(key + probe) % Capacity];
+			unsigned long long placed = method.m_key.load(std::memory_order_acquire);
+			if(placed == 0)
+			{
+				// The name is only read once the calls are over, when the
+				// statistics are looked at.
+				if(method.m_key.compare_exchange_strong(placed, key, std::memory_order_acq_rel))
+				{
+					method.m_name = methodName ;
+					return &method ;
+				}
+			}
+			if(placed == key)
+			{
+				return &method ;
+			}
+		}
+		return NULL ;
+	}
+};
+
+class Mock
+{
+public:    
+    Mock()
+        : m_className(""),m_mockNotifier(NULL), m_notifierAlreadyExecuted(false), m_violations(NULL), m_statistics(NULL)
+    {        
+    }
+
+    Mock(const std::string& className)
+        : m_expectations(className), m_className(className),m_mockNotifier(NULL), m_notifierAlreadyExecuted(false), m_violations(NULL), m_statistics(NULL)
+    {		
+    }
+
+	virtual ~Mock()
+	{
+		Unstub();
+	}
+	
+        TinyMock::BaseMethod& RegisterExpectation(TinyMock::BaseMethod* exp)
+	{						
+		return m_expectations.AddExpectationFor(exp->Signature(),exp);
+	}
+
+	// For callers that register many expectations of the same method and
+	// keep its signature around.
+        TinyMock::BaseMethod& RegisterExpectation(const std::string& signature, TinyMock::BaseMethod* exp)
+	{						
+		return m_expectations.AddExpectationFor(signature,exp);
+	}
+
+	// Registers the expectation at the next position of 'sequence'.
+        TinyMock::BaseMethod& RegisterExpectation(Sequence& sequence, TinyMock::BaseMethod* exp)
+	{
+		exp->PlaceInSequence(&sequence, sequence.Enlist(m_className + "::" + exp->ToString()));
+		return RegisterExpectation(exp);
+	}
+
+	// Expectations that the source keeps, or makes on demand, for this mock;
+	// the source has to outlive the mock or its expectations.
+	void AddExpectationSource(ExpectationSource* source)
+	{
+		m_expectations.AddSource(source);
+	}
+	// For a source whose expectations come and go after it was added.
+	void SourceRegistered(size_t count)
+	{
+		m_expectations.Registered(count);
+	}
+	void SourceConsumed(size_t count)
+	{
+		m_expectations.Consumed(count);
+	}
+
+	void ClearExpectations()
+	{
+		m_expectations.Clear();
+	}
+	void ClearExpectations(const std::string& signature)
+	{
+		m_expectations.Clear(signature);
+	}
+
+	const std::string& ClassName() const
+	{
+		return m_className ;
+	}
+
+	// Brings the mock back to the state it was created in, without stubs,
+	// keeping the storage of its expectations. Mocks with state of their own can
+	// extend it.
+	virtual void Reset()
+	{
+		m_expectations.Clear();
+		m_expectations.Clean();
+		m_ignoredMethods.clear();
+		Unstub();
+		m_notifierAlreadyExecuted = false ;
+	}
+
+	void Rename(const std::string& className)
+	{
+		m_className = className ;
+		m_expectations.Rename(className);
+	}
+
+	void RegisterFailureNotifier(TinyNotifier* mockNotifier)
+	{
+		m_mockNotifier = mockNotifier;
+	}
+
+	void IgnoreAll(const std::string& methodName)
+	{
+		m_ignoredMethods.ignoreAll(methodName);
+	}
+
+	// Stub mode: the method is served by the returned action and its calls
+	// are not verified. The mocked method has to check for it first, e.g.
+	//
+	//	static const TinyMock::StubId stub("Read", typeid(int));
+	//	if(IsStubbed(stub)) return Stubbed<int>(stub);
+	template <typename R>
+	StubAction<R>& Stub(const std::string& methodName)
+	{
+		const size_t index = StubId::IndexOf(methodName, typeid(R));
+		if(index >= m_stubs.size())
+		{
+			m_stubs.resize(index + 1, NULL);
+		}
+		delete m_stubs[index];
+		StubAction<R>* action = new StubAction<R>();
+		m_stubs[index] = action ;
+		return *action ;
+	}
+
+	bool IsStubbed(const StubId& stub) const
+	{
+		return stub.Index() < m_stubs.size() && m_stubs[stub.Index()] != NULL ;
+	}
+
+	template <typename R>
+	R Stubbed(const StubId& stub)
+	{
+		assert(stub.Result() == typeid(R));
+		return static_cast<StubAction<R>*>(m_stubs[stub.Index()])->Next();
+	}
+
+	void Unstub()
+	{
+		for(size_t i = 0; i < m_stubs.size(); ++i)
+		{
+			delete m_stubs[i];
+			m_stubs[i] = NULL ;
+		}
+	}
+
+	// Violations go to the log instead of the failure notifier.
+	void CollectViolations(ViolationLog* violations)
+	{
+		m_violations = violations ;
+	}
+
+	// Every call that reaches Handle(), or a StaticMethod, is counted and
+	// timed in 'statistics'.
+	void RecordCallStatistics(CallStatistics* statistics)
+	{
+		m_statistics = statistics ;
+	}
+    
+        void Handle(TinyMock::BaseMethod* expected, TinyMock::BaseMethod* actual)
+	{
+		CountCall(actual->Name());
+		if(ActualMethodShouldBeIgnored(*actual))
+		{
+			return;
+		}		
+
+		if(CallIsNotExpected(expected))
+		{
+			HandleNotExpectedCall(*actual);			
+			return ;		
+		}
+
+		if(ExpectedAndActualAreDifferent(*expected,*actual))
+		{
+			HandleExpectedAndActualDifferent(expected,actual);
+			return;
+		}
+
+		if(expected->InSequence())
+		{
+			CheckOrder(*expected->InSequence(), expected->PositionInSequence());
+		}
+		
+		try
+		{
+			expected->ExecuteMockNotifier();
+		}
+		catch(...)
+		{
+			expected->Release();
+			throw;
+		}
+        expected->Release();
+	}
+
+	bool UnhandledExpectations()
+	{
+		return m_expectations.UnhandledExpectations();
+	}	
+
+	void PrintPendingExpectations(std::ostream& os)
+	{
+		m_expectations.PrintPendingExpectations(os);
+	}
+
+	void TrackExpectations(ExpectationTracker* tracker)
+	{
+		m_expectations.Track(tracker);
+	}
+	
+	void ExecuteMockFailureNotifier()
+	{
+		if(! m_notifierAlreadyExecuted)
+		{
+			m_notifierAlreadyExecuted = true;
+			m_mockNotifier->Send(false);
+		}
+	}
+
+protected:
+	Expectations m_expectations ;
+	TinyNotifier* m_mockNotifier ;
+
+	void CountCall(const std::string& methodName)
+	{
+		if(m_statistics)
+		{
+			m_statistics->Record(methodName);
+		}
+	}
+	bool IsIgnored(const std::string& methodName)
+	{
+		return m_ignoredMethods.isIgnored(methodName);
+	}
+	// 'expected' and 'actual' are calls formatted as Name(arguments).
+	void ReportNotExpected(const std::string& actual) ;
+	void CheckOrder(Sequence& sequence, size_t position)
+	{
+		size_t skipped = 0 ;
+		if(!sequence.Advance(position, skipped))
+		{
+			ReportOutOfOrder(sequence.Call(skipped), sequence.Call(position));
+		}
+	}
+	// Both calls are qualified with the name of their mock.
+	void ReportOutOfOrder(const std::string& expected, const std::string& actual) ;
+	void ReportExpectedAndActualDifferent(const std::string& expected, const std::string& actual) ;
+private:
+    std::string m_className ;
+	IgnoredMethodsContainer m_ignoredMethods ;
+	bool m_notifierAlreadyExecuted;
+	ViolationLog* m_violations ;
+	CallStatistics* m_statistics ;
+	std::vector<StubActionBase*> m_stubs ;
+
+        bool ActualMethodShouldBeIgnored(TinyMock::BaseMethod& actual)
+	{
+		return m_ignoredMethods.isIgnored(actual.GetName()) ;		
+	}
+        bool CallIsNotExpected(TinyMock::BaseMethod* expected)
+	{
+		return static_cast<bool>(!expected);		
+	}
+        bool ExpectedAndActualAreDifferent(TinyMock::BaseMethod& expected,TinyMock::BaseMethod& actual)
+	{
+		return !(expected==actual);
+	}	
+        void HandleExpectedAndActualDifferent(TinyMock::BaseMethod* expected,TinyMock::BaseMethod* actual)
+	{
+		ReportExpectedAndActualDifferent(expected->ToString(), actual->ToString());
+		expected->Release();
+	}
+        void HandleNotExpectedCall(TinyMock::BaseMethod& actual)
+	{
+		ReportNotExpected(actual.ToString());
+	}
+};
+
+class LiveRepository
+{
+public:
+	virtual ~LiveRepository() {}
+	virtual void PrintPendingExpectations(std::ostream& os) = 0;
+};
+
+// Keeps track of the mock repositories that currently exist, so that a test
+// runner can show what a hanging test was still waiting for.
+class LiveRepositories
+{
+public:
+	static void Add(LiveRepository* repository)
+	{
+		std::lock_guard<std::mutex> lock(Mutex());
+		Repositories().push_back(repository);
+	}
+	static void Remove(LiveRepository* repository)
+	{
+		std::lock_guard<std::mutex> lock(Mutex());
+		std::vector<LiveRepository*>& repositories = Repositories();
+		repositories.erase(std::remove(repositories.begin(), repositories.end(), repository), repositories.end());
+	}
+	static void PrintPendingExpectations(std::ostream& os) ;
+private:
+	static std::mutex& Mutex()
+	{
+		static std::mutex mutex ;
+		return mutex ;
+	}
+	static std::vector<LiveRepository*>& Repositories()
+	{
+		static std::vector<LiveRepository*> repositories ;
+		return repositories ;
+	}
+};
+
+template<typename P=TinyNotifier>
+class MockRepository : public LiveRepository
+{
+public:	
+	MockRepository() : m_collectingViolations(false), m_timeSource(NULL)
+	{
+		m_mockNotifier = new P();
+		LiveRepositories::Add(this);
+	}	
+
+	~MockRepository()
+	{
+		LiveRepositories::Remove(this);
+		delete m_mockNotifier;
+		for(MockContainer::iterator p=m_mocks.begin(); p!=m_mocks.end(); ++p)
+		{			
+			delete p->second;
+		}
+
+		for(MockPool::iterator p=m_pool.begin(); p!=m_pool.end(); ++p)
+		{
+			for(std::vector<Mock*>::iterator m=p->second.begin(); m!=p->second.end(); ++m)
+			{
+				delete (*m);
+			}
+		}
+
+		for(FailureNotifierContainer::iterator p=m_failureNotifiers.begin(); p!=m_failureNotifiers.end(); ++p)
+		{
+			delete (*p);
+		}
+
+		for(StatisticsContainer::iterator p=m_statistics.begin(); p!=m_statistics.end(); ++p)
+		{
+			delete p->second;
+		}
+	}
+	
+	bool verifyAll()
+	{
+		Reconcile();
+		const bool violated = ReportViolations();
+		if(!HasUnhandledExpectations() && !violated)
+		{
+			return true ;
+		}
+		else
+		{
+			Fail();
+			return false;
+		}
+	}
+
+	// Also reports the violations collected so far, of any mock.
+	bool verify(const std::string& mockName)
+	{
+		if(m_mocks.end() == m_mocks.find(mockName))
+		{
+			return false;
+		}
+
+		Reconcile();
+		const bool violated = ReportViolations();
+		if(m_mocks[mockName]->UnhandledExpectations() || violated)
+		{
+			Fail();
+			return false;
+		}
+		return true ;		
+	}		
+
+	bool verifyAll(TinyNotifier& notifier)
+	{
+		Reconcile();
+		const bool violated = ReportViolations();
+		if(!HasUnhandledExpectations() && !violated)
+		{
+			return true ;
+		}
+		else
+		{
+			Fail(notifier);
+			return false;
+		}
+	}
+
+	size_t OutstandingExpectations() const
+	{
+		Reconcile();
+		return m_tracker.Outstanding();
+	}
+
+	// Soft-fail mode: violations of the owned mocks are appended to a log of
+	// 'capacity' preallocated entries instead of going to their failure
+	// notifiers, and are all reported at the next verifyAll().
+	void CollectViolations(size_t capacity = 1024)
+	{
+		m_violations.Reserve(capacity);
+		m_collectingViolations = true ;
+		for(MockContainer::iterator p=m_mocks.begin(); p!=m_mocks.end(); ++p)
+		{
+			p->second->CollectViolations(ViolationsOfMocks());
+		}
+	}
+
+	virtual const ViolationLog& Violations() const
+	{
+		return m_violations ;
+	}
+
+	// Counts the calls of every method of the owned mocks and records the
+	// distribution of the times between them; 'now' gives the time in
+	// nanoseconds.
+	void RecordCallStatistics(TimeSource now = &SteadyNanoseconds)
+	{
+		m_timeSource = now ;
+		for(MockContainer::iterator p=m_mocks.begin(); p!=m_mocks.end(); ++p)
+		{
+			RecordCallStatistics(p->second);
+		}
+	}
+
+	// NULL when there is no such mock or its calls are not recorded.
+	const CallStatistics* CallStatisticsOf(const std::string& mockName) const
+	{
+		MockContainer::const_iterator mock = m_mocks.find(mockName);
+		if(mock == m_mocks.end())
+		{
+			return NULL ;
+		}
+		StatisticsContainer::const_iterator statistics = m_statistics.find(mock->second);
+		return statistics == m_statistics.end() ? NULL : statistics->second ;
+	}
+
+	// One line per mocked method that was called.
+	void PrintCallStatistics(std::ostream& os) const
+	{
+		for(MockContainer::const_iterator p=m_mocks.begin(); p!=m_mocks.end(); ++p)
+		{
+			if(const CallStatistics* statistics = CallStatisticsOf(p->first))
+			{
+				statistics->Print(os, p->first);
+			}
+		}
+	}
+
+	// Clears the expectations, ignored methods, failure notifier state and
+	// collected violations of all the owned mocks, which stay in place with
+	// their storage; for running the same scenario over and over.
+	virtual void Reset()
+	{
+		Reconcile();
+		for(MockContainer::iterator p=m_mocks.begin(); p!=m_mocks.end(); ++p)
+		{
+			p->second->Reset();
+		}
+		m_tracker.Dirty().clear();
+		m_violations.Clear();
+		for(StatisticsContainer::iterator p=m_statistics.begin(); p!=m_statistics.end(); ++p)
+		{
+			p->second->Clear();
+		}
+	}
+
+	// Resets the owned mocks and puts them aside by type: CreateMock and
+	// CreateMockWithoutFailureNotifier hand them out again, under their new
+	// names, before creating any new mock of that type.
+	void Recycle()
+	{
+		Reset();
+		for(MockContainer::iterator p=m_mocks.begin(); p!=m_mocks.end(); ++p)
+		{
+			m_pool[m_poolKeys[p->second]].push_back(p->second);
+		}
+		m_mocks.clear();
+		m_poolKeys.clear();
+	}
+
+	template<typename T, typename N> 
+	T* CreateMock(const std::string& mockName)
+	{
+		if(T* mock = Pooled<T, N>(mockName))
+		{
+			return mock;
+		}
+		T* mock = new T(mockName);
+		N* failureNotifier = new N();
+		mock->RegisterFailureNotifier(failureNotifier);
+		m_failureNotifiers.push_back(failureNotifier);		
+		Own(mockName, mock, PoolKey<T, N>());
+		return mock;
+	}
+
+	template<typename T, typename N> 
+	T* CreateMockWithoutOwnership(const std::string& mockName)
+	{
+		T* mock = new T(mockName);
+		N* failureNotifier = new N();
+		mock->RegisterFailureNotifier(failureNotifier);
+		m_failureNotifiers.push_back(failureNotifier);		
+		return mock;
+	}
+
+	template<typename T>
+	T* CreateMockWithoutFailureNotifier(const std::string& mockName)
+	{
+		if(T* mock = Pooled<T, void>(mockName))
+		{
+			return mock;
+		}
+		T* mock = new T(mockName);				
+		Own(mockName, mock, PoolKey<T, void>());
+		return mock;
+	}
+
+	void PrintPendingExpectations(std::ostream& os)
+	{
+		Reconcile();
+		for(MockContainer::iterator p=m_mocks.begin(); p!=m_mocks.end(); ++p)
+		{
+			p->second->PrintPendingExpectations(os);
+		}
+	}
+
+	void Fail()
+	{
+		m_mockNotifier->Send(false);
+	}
+
+	void Fail(TinyNotifier& notifier)
+	{
+		notifier.Send(false);
+	}
+protected:
+	// Brings the expectation counts of the owned mocks up to date before
+	// they are read; for expectations met outside this repository.
+	virtual void Reconcile() const {}
+
+	// Where the owned mocks put their violations; NULL when they go to
+	// their failure notifiers.
+	virtual ViolationLog* ViolationsOfMocks()
+	{
+		return m_collectingViolations ? &m_violations : NULL ;
+	}
+
+	// Reports and clears the collected violations; true if there were any.
+	virtual bool ReportViolations()
+	{
+		if(m_violations.IsEmpty())
+		{
+			return false ;
+		}
+		m_violations.Report();
+		m_violations.Clear();
+		return true ;
+	}
+private:
+	typedef std::map<std::string,Mock*> MockContainer;
+	typedef std::vector<TinyNotifier*> FailureNotifierContainer;
+	typedef const void* PoolKey_t;
+	typedef std::map<PoolKey_t,std::vector<Mock*> > MockPool;
+	typedef std::map<Mock*,CallStatistics*> StatisticsContainer;
+	MockContainer m_mocks ;	
+	MockPool m_pool ;
+	std::map<Mock*,PoolKey_t> m_poolKeys ;
+	FailureNotifierContainer m_failureNotifiers;
+	P* m_mockNotifier ;		
+	ExpectationTracker m_tracker ;
+	ViolationLog m_violations ;
+	bool m_collectingViolations ;
+	StatisticsContainer m_statistics ;
+	TimeSource m_timeSource ;
+
+	// One key per mock type and failure notifier type; a recycled mock
+	// keeps the failure notifier it was created with.
+	template<typename T, typename N>
+	static PoolKey_t PoolKey()
+	{
+		static const char key = 0 ;
+		return &key ;
+	}
+
+	template<typename T, typename N>
+	T* Pooled(const std::string& mockName)
+	{
+		MockPool::iterator p = m_pool.find(PoolKey<T, N>());
+		if(p == m_pool.end() || p->second.empty())
+		{
+			return NULL ;
+		}
+		T* mock = static_cast<T*>(p->second.back());
+		p->second.pop_back();
+		mock->Rename(mockName);
+		Own(mockName, mock, p->first);
+		return mock ;
+	}
+
+	void Own(const std::string& mockName, Mock* mock, PoolKey_t key)
+	{
+		mock->TrackExpectations(&m_tracker);
+		if(ViolationLog* violations = ViolationsOfMocks())
+		{
+			mock->CollectViolations(violations);
+		}
+		if(m_timeSource)
+		{
+			RecordCallStatistics(mock);
+		}
+		m_mocks[mockName] = mock;
+		m_poolKeys[mock] = key;
+	}
+
+	void RecordCallStatistics(Mock* mock)
+	{
+		CallStatistics*& statistics = m_statistics[mock];
+		if(!statistics)
+		{
+			statistics = new CallStatistics(m_timeSource);
+		}
+		mock->RecordCallStatistics(statistics);
+	}
+
+	// O(1) when everything is satisfied; otherwise only the mocks that got
+	// expectations since the last verification are walked for the report.
+	bool HasUnhandledExpectations()
+	{
+		if(m_tracker.Outstanding() == 0)
+		{
+			return false ;
+		}
+		std::vector<Expectations*> dirty ;
+		dirty.swap(m_tracker.Dirty());
+		std::sort(dirty.begin(), dirty.end(), ByClassName);
+		bool unhandled = false ;
+		for(std::vector<Expectations*>::iterator e = dirty.begin(); e != dirty.end(); ++e)
+		{
+			if((*e)->UnhandledExpectations())
+			{
+				unhandled = true ;
+			}
+			(*e)->Clean();
+		}
+		return unhandled ;
+	}
+};
+
+}
+
+#endif
@@ -0,0 +1,369 @@
+#ifndef TINYMOCKFUZZ_H
+#define TINYMOCKFUZZ_H
+
+/*
+In-process fuzzing against mocked dependencies.
+
+A FuzzDriver decodes the bytes of one fuzzer input into a sequence of
+responses and registers them as expectations of mocked methods ("channels"):
+a return value, a return value after a delay, or an injected failure. The
+repository, the mocks and a fixed pool of expectations per channel are set
+up once; feeding an input only recycles pooled expectations, so the driver
+does not allocate in steady state.
+
+	class Fixture : public TinyMock::FuzzFixture
+	{
+	public:
+		Fixture()
+		{
+			dependency = repository.CreateMock<DependencyMock,Notifier>("Dependency");
+			Driver().AddChannel(dependency, TinyMock::Method<void,void,void,void,int>("Read",0), 64);
+		}
+		void Run()
+		{
+			SystemUnderTest(dependency).Poll();
+		}
+		TinyMock::MockRepository<Notifier> repository ;
+		DependencyMock* dependency ;
+	};
+
+	TINYMOCK_FUZZ_TARGET(Fixture)
+*/
+
+#include <stdint.h>
+#include <string.h>
+#include <exception>
+#include <functional>
+#include <type_traits>
+#include <vector>
+
+#include "TinyMock.h"
+
+namespace TinyMock {
+
+// Reads values from the fuzzer input front to back; once the input is used
+// up every value reads as zero.
+class FuzzedInput
+{
+public:
+	FuzzedInput() : m_data(NULL), m_size(0) {}
+	void Reset(const uint8_t* data, size_t size)
+	{
+		m_data = data ;
+		m_size = size ;
+	}
+	size_t Remaining() const
+	{
+		return m_size ;
+	}
+	uint8_t ConsumeByte()
+	{
+		uint8_t byte = 0 ;
+		ConsumeBytes(&byte, 1);
+		return byte ;
+	}
+	bool ConsumeBool()
+	{
+		return (ConsumeByte() & 1) != 0 ;
+	}
+	template <typename T>
+	T ConsumeIntegral()
+	{
+		T value = T();
+		ConsumeBytes(&value, sizeof(T));
+		return value ;
+	}
+	void ConsumeBytes(void* destination, size_t size)
+	{
+		const size_t available = size < m_size ? size : m_size ;
+		memset(destination, 0, size);
+		memcpy(destination, m_data, available);
+		m_data += available ;
+		m_size -= available ;
+	}
+private:
+	const uint8_t* m_data ;
+	size_t m_size ;
+};
+
+// Decodes a return value of type R; specialise it for return types that are
+// not plain bytes.
+template <typename R>
+struct FuzzValue
+{
+	static_assert(std::is_trivially_copyable<R>::value, "specialise FuzzValue for this type");
+	static R Consume(FuzzedInput& input)
+	{
+		return input.ConsumeIntegral<R>();
+	}
+};
+
+template <>
+struct FuzzValue<bool>
+{
+	static bool Consume(FuzzedInput& input)
+	{
+		return input.ConsumeBool();
+	}
+};
+
+class InjectedFailure : public std::exception
+{
+public:
+	virtual const char* what() const throw()
+	{
+		return "failure injected by the fuzz driver" ;
+	}
+};
+
+struct FuzzResponse
+{
+	enum Action { Return, Delay, Fail, Actions };
+};
+
+class FuzzDriver;
+
+template <typename M>
+auto AssignFuzzedResult(M& method, FuzzedInput& input, int) -> decltype(method.m_r, void())
+{
+	method.m_r = FuzzValue<decltype(method.m_r)>::Consume(input);
+}
+
+template <typename M>
+void AssignFuzzedResult(M&, FuzzedInput&, long)
+{
+}
+
+class FuzzChannelBase : public MethodRecycler
+{
+public:
+	virtual ~FuzzChannelBase() {}
+	// Registers the next response decoded from the input; false when the
+	// pool of the channel is used up.
+	virtual bool Feed(FuzzedInput& input, FuzzDriver& driver) = 0;
+	virtual void Clear() = 0;
+};
+
+// A pooled expectation that is its own notifier, so that it can carry the
+// delay or failure it was decoded with.
+template <typename M>
+class FuzzedExpectation : public M, public TinyNotifier
+{
+public:
+	FuzzedExpectation(const M& prototype) : M(prototype), m_driver(NULL), m_action(FuzzResponse::Return), m_delay(0) {}
+	// Copies of a method do not keep its settings, so this is done once the
+	// expectation has its place in the pool.
+	void Pool(MethodRecycler* recycler)
+	{
+		M::ignoreArguments();
+		M::AddNotifier(this);
+		M::RecycleWith(recycler);
+	}
+	void Respond(FuzzDriver* driver, FuzzResponse::Action action, unsigned delay)
+	{
+		m_driver = driver ;
+		m_action = action ;
+		m_delay = delay ;
+	}
+	void Send(bool status=true);
+private:
+	FuzzDriver* m_driver ;
+	FuzzResponse::Action m_action ;
+	unsigned m_delay ;
+};
+
+template <typename M>
+class FuzzChannel : public FuzzChannelBase
+{
+public:
+	FuzzChannel(Mock* mock, const M& prototype, size_t capacity)
+		: m_mock(mock), m_signature(SignatureOf(prototype)), m_pool(capacity, FuzzedExpectation<M>(prototype))
+	{
+		m_free.reserve(capacity);
+		for(size_t i = 0; i < m_pool.size(); ++i)
+		{
+			m_pool[i].Pool(this);
+			m_free.push_back(&m_pool[i]);
+		}
+	}
+	bool Feed(FuzzedInput& input, FuzzDriver& driver)
+	{
+		if(m_free.empty())
+		{
+			return false ;
+		}
+		FuzzedExpectation<M>* expectation = m_free.back();
+		m_free.pop_back();
+		const FuzzResponse::Action action = FuzzResponse::Action(input.ConsumeByte() % FuzzResponse::Actions);
+		const unsigned delay = action == FuzzResponse::Delay ? input.ConsumeIntegral<uint16_t>() : 0 ;
+		AssignFuzzedResult<M>(*expectation, input, 0);
+		expectation->Respond(&driver, action, delay);
+		m_mock->RegisterExpectation(m_signature, expectation);
+		return true ;
+	}
+	void Clear()
+	{
+		m_mock->ClearExpectations(m_signature);
+	}
+	void Recycle(BaseMethod* method)
+	{
+		m_free.push_back(static_cast<FuzzedExpectation<M>*>(method));
+	}
+	size_t Available() const
+	{
+		return m_free.size();
+	}
+private:
+	Mock* m_mock ;
+	std::string m_signature ;
+	std::vector<FuzzedExpectation<M> > m_pool ;
+	std::vector<FuzzedExpectation<M>*> m_free ;
+
+	static std::string SignatureOf(M prototype)
+	{
+		return prototype.Signature();
+	}
+};
+
+class FuzzDriver
+{
+public:
+	typedef std::function<void(unsigned milliseconds)> DelayHook ;
+	typedef void (*FailureHook)();
+
+	FuzzDriver() : m_onFailure(&ThrowInjectedFailure), m_delayed(0), m_failures(0) {}
+	// The mocks may already be gone, so they are not touched here.
+	~FuzzDriver()
+	{
+		for(size_t i = 0; i < m_channels.size(); ++i)
+		{
+			delete m_channels[i];
+		}
+	}
+
+	// 'prototype' gives the method and its signature; 'capacity' bounds the
+	// number of responses of this channel per input.
+	template <typename M>
+	FuzzChannel<M>& AddChannel(Mock* mock, const M& prototype, size_t capacity)
+	{
+		FuzzChannel<M>* channel = new FuzzChannel<M>(mock, prototype, capacity);
+		m_channels.push_back(channel);
+		return *channel ;
+	}
+
+	// Called when a delayed response is served, e.g. to advance a
+	// VirtualClock; by default delays are only added up, see Delayed().
+	void OnDelay(DelayHook hook)
+	{
+		m_onDelay = hook ;
+	}
+	// Called when a failing response is served; throws InjectedFailure by
+	// default.
+	void OnFailure(FailureHook hook)
+	{
+		m_onFailure = hook ;
+	}
+
+	// Drops whatever the channels' methods still expect from the previous
+	// input and registers the responses decoded from this one: a channel
+	// selector byte, an action byte, a 16 bit delay for delayed responses
+	// and the return value.
+	void Load(const uint8_t* data, size_t size)
+	{
+		for(size_t i = 0; i < m_channels.size(); ++i)
+		{
+			m_channels[i]->Clear();
+		}
+		m_delayed = 0 ;
+		m_failures = 0 ;
+		if(m_channels.empty())
+		{
+			return ;
+		}
+		m_input.Reset(data, size);
+		while(m_input.Remaining())
+		{
+			m_channels[m_input.ConsumeByte() % m_channels.size()]->Feed(m_input, *this);
+		}
+	}
+
+	unsigned long long Delayed() const
+	{
+		return m_delayed ;
+	}
+	size_t Failures() const
+	{
+		return m_failures ;
+	}
+
+	void Serve(FuzzResponse::Action action, unsigned delay)
+	{
+		if(action == FuzzResponse::Delay)
+		{
+			m_delayed += delay ;
+			if(m_onDelay)
+			{
+				m_onDelay(delay);
+			}
+		}
+		if(action == FuzzResponse::Fail)
+		{
+			++m_failures ;
+			m_onFailure();
+		}
+	}
+
+private:
+	std::vector<FuzzChannelBase*> m_channels ;
+	FuzzedInput m_input ;
+	DelayHook m_onDelay ;
+	FailureHook m_onFailure ;
+	unsigned long long m_delayed ;
+	size_t m_failures ;
+
+	static void ThrowInjectedFailure()
+	{
+		throw InjectedFailure();
+	}
+};
+
+template <typename M>
+void FuzzedExpectation<M>::Send(bool)
+{
+	m_driver->Serve(m_action, m_delay);
+}
+
+// Base of the long-lived state of a fuzz target: the repository, the mocks
+// and the driver are built once, Run() drives the system under test once per
+// input.
+class FuzzFixture
+{
+public:
+	virtual ~FuzzFixture() {}
+	virtual void Run() = 0;
+	FuzzDriver& Driver()
+	{
+		return m_driver ;
+	}
+private:
+	FuzzDriver m_driver ;
+};
+
+template <typename F>
+int RunFuzzInput(const uint8_t* data, size_t size)
+{
+	static F fixture ;
+	fixture.Driver().Load(data, size);
+	fixture.Run();
+	return 0 ;
+}
+
+}
+
+#define TINYMOCK_FUZZ_TARGET(Fixture) \
+	extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) \
+	{ \
+		return TinyMock::RunFuzzInput<Fixture>(data, size); \
+	}
+
+#endif
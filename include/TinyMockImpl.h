@@ -0,0 +1,233 @@
+#ifndef TINYMOCKIMPL_H
+#define TINYMOCKIMPL_H
+
+// What TinyMock prints: violations, pending expectations, statistics and the
+// text of mocked calls. TinyMock.h includes this in every translation unit,
+// unless TINYMOCK_LEAN is defined; then it is compiled once, into the TinyMock
+// library, see src/TinyMock.cpp.
+
+#include <iostream>
+#include <sstream>
+
+#include "TinyMockCore.h"
+#include "TinyMockMethods.h"
+
+namespace TinyMock {
+
+TINYMOCK_INLINE std::string BaseMethod::Signature()
+{
+	if(!m_descriptor)
+	{
+		return std::string("I am just a base type...");
+	}
+	const MethodDescriptor& descriptor = *m_descriptor ;
+	const bool returnsVoid = *descriptor.result == typeid(void);
+	std::string signature = std::string(returnsVoid ? "void" : descriptor.result->name()) + " " + m_name ;
+	if(descriptor.anyArguments)
+	{
+		return signature + "(...)" ;
+	}
+	if(descriptor.arity == 0)
+	{
+		return signature + (returnsVoid ? "()" : "(void)");
+	}
+	signature += "(" ;
+	for(size_t p = 0; p < descriptor.arity; ++p)
+	{
+		if(p)
+		{
+			signature += "," ;
+		}
+		signature += descriptor.parameters[p]->name();
+	}
+	return signature + ")" ;
+}
+
+TINYMOCK_INLINE std::string BaseMethod::ToString()
+{
+	if(!m_descriptor)
+	{
+		return std::string("I am just a base type...");
+	}
+	if(m_descriptor->anyArguments)
+	{
+		return m_name + "(...)" ;
+	}
+	CallText text(m_name);
+	for(size_t p = 0; p < m_descriptor->arity; ++p)
+	{
+		text.Append(m_descriptor->argument(*this, p), m_descriptor->formats[p]);
+	}
+	return text.Str();
+}
+
+TINYMOCK_INLINE void Expectations::PrintPendingExpectations(std::ostream& os)
+{
+	typedef std::map<std::string,TinyMock::ExpectationQueue>::iterator I ;
+	for(I m = m_methods.begin() ; m != m_methods.end(); ++m)
+	{
+		for(size_t e = 0 ; e < m->second.size(); ++e)
+		{
+			os << m_className << "::" << m->second[e]->ToString() << std::endl ;
+		}
+	}
+	for(size_t s = 0; s < m_sources.size(); ++s)
+	{
+		m_sources[s]->PrintPending(os, m_className);
+	}
+}
+
+TINYMOCK_INLINE void Expectations::PrintExpectations(const std::string & signature, TinyMock::ExpectationQueue & deque)
+{
+	if(!MockPrinter::Silent())
+	{
+		std::cout << std::endl << deque.front()->Signature() << " : Expectations violated. Expected calls:" << std::endl ;
+	}
+	Consumed(deque.size());
+
+	while(deque.size())
+	{
+		if(!MockPrinter::Silent())
+		{
+			std::cout << m_className << "::" << deque.front()->ToString() << std::endl ;
+		}
+		deque.front()->Release();
+		deque.pop_front();
+	}
+}
+
+TINYMOCK_INLINE void Expectations::PrintExpectations(ExpectationSource& source)
+{
+	if(!MockPrinter::Silent())
+	{
+		std::cout << std::endl << source.Signature() << " : Expectations violated. Expected calls:" << std::endl ;
+		source.PrintPending(std::cout, m_className);
+	}
+	Consumed(source.Pending());
+	source.Clear();
+}
+
+TINYMOCK_INLINE void ViolationLog::Print(std::ostream& os) const
+{
+	for(size_t i = 0; i < m_size; ++i)
+	{
+		const Violation& violation = m_violations[i];
+		if(violation.kind == Violation::NotExpected)
+		{
+			os << std::endl << "Expectation violated ! Call not expected:" << std::endl ;
+			os << violation.mockName << "::" << violation.actual << std::endl ;
+		}
+		else if(violation.kind == Violation::OutOfOrder)
+		{
+			os << std::endl << "Expectation violated ! Call out of order:" << std::endl ;
+			os << "Expected first: " << violation.expected << std::endl ;
+			os << "Actual: " << violation.actual << std::endl ;
+		}
+		else
+		{
+			os << std::endl << "Expectation violated !" << std::endl ;
+			os << "Expected: " << violation.mockName << "::" << violation.expected << std::endl ;
+			os << "Actual: " << violation.mockName << "::" << violation.actual << std::endl ;
+		}
+	}
+	if(m_dropped)
+	{
+		os << std::endl << m_dropped << " more violations not recorded" << std::endl ;
+	}
+}
+
+TINYMOCK_INLINE void ViolationLog::Report() const
+{
+	if(!MockPrinter::Silent())
+	{
+		Print(std::cout);
+	}
+}
+
+TINYMOCK_INLINE void CallStatistics::Print(std::ostream& os, const std::string& className) const
+{
+	std::vector<const MethodStatistics*> methods = Methods();
+	for(size_t m = 0; m < methods.size(); ++m)
+	{
+		const MethodStatistics& method = *methods[m];
+		os << className << "::" << method.Name() << " calls=" << method.Calls()
+		   << " mean=" << method.Mean() << "ns p50=" << method.Percentile(50) << "ns p99=" << method.Percentile(99)
+		   << "ns max=" << method.Percentile(100) << "ns burstiness=" << method.Burstiness() << std::endl ;
+	}
+	if(Dropped())
+	{
+		os << className << ": " << Dropped() << " calls of further methods not recorded" << std::endl ;
+	}
+}
+
+TINYMOCK_INLINE void Mock::ReportNotExpected(const std::string& actual)
+{
+	if(m_violations)
+	{
+		m_violations->Append(Violation::NotExpected, m_className, std::string(), actual);
+		return ;
+	}
+	if(!MockPrinter::Silent())
+	{
+		std::cout << std::endl << "Expectation violated ! Call not expected:" << std::endl ;
+		std::cout << m_className << "::" << actual << std::endl ;
+	}
+	ExecuteMockFailureNotifier();
+}
+
+TINYMOCK_INLINE void Mock::ReportOutOfOrder(const std::string& expected, const std::string& actual)
+{
+	if(m_violations)
+	{
+		m_violations->Append(Violation::OutOfOrder, m_className, expected, actual);
+		return ;
+	}
+	if(!MockPrinter::Silent())
+	{
+		std::cout << std::endl << "Expectation violated ! Call out of order:" << std::endl ;
+		std::cout << "Expected first: " << expected << std::endl ;
+		std::cout << "Actual: " << actual << std::endl ;
+	}
+	ExecuteMockFailureNotifier();
+}
+
+TINYMOCK_INLINE void Mock::ReportExpectedAndActualDifferent(const std::string& expected, const std::string& actual)
+{
+	if(m_violations)
+	{
+		m_violations->Append(Violation::ExpectedAndActualDifferent, m_className, expected, actual);
+		return ;
+	}
+	if(!MockPrinter::Silent())
+	{
+		std::cout << std::endl << "Expectation violated !" << std::endl ;
+		std::cout << "Expected: " << m_className << "::" << expected << std::endl ;
+		std::cout << "Actual: " << m_className << "::" << actual << std::endl ;
+	}
+	ExecuteMockFailureNotifier();
+}
+
+TINYMOCK_INLINE void LiveRepositories::PrintPendingExpectations(std::ostream& os)
+{
+	std::lock_guard<std::mutex> lock(Mutex());
+	os << "Pending expectations of live mock repositories:" << std::endl ;
+	for(std::vector<LiveRepository*>::iterator r = Repositories().begin(); r != Repositories().end(); ++r)
+	{
+		(*r)->PrintPendingExpectations(os);
+	}
+}
+
+TINYMOCK_INLINE void CallText::Append(const void* value, Format format)
+{
+	std::ostringstream out ;
+	if(m_arguments++)
+	{
+		out << "," ;
+	}
+	format(out, value);
+	m_text += out.str();
+}
+
+}
+
+#endif
@@ -0,0 +1,841 @@
+#ifndef TINYMOCKMETHODS_H
+#define TINYMOCKMETHODS_H
+
+// The mocked methods: static mocks, expectation generators and the Method
+// family. Calls are formatted only for violations, through CallText, so a
+// mocked method carries no stream code of its own.
+
+#include <ostream>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+
+#include "TinyMockCore.h"
+
+namespace TinyMock {
+
+template <typename T>
+void FormatValue(std::ostream& os, const void* value)
+{
+	os << *static_cast<const T*>(value);
+}
+
+// Builds "Name(a,b)". Each argument is formatted by a small function of its
+// type into a stream that lives out of line.
+class CallText
+{
+public:
+	typedef MethodDescriptor::Format Format ;
+
+	explicit CallText(const std::string& name) : m_text(name + "("), m_arguments(0) {}
+
+	template <typename T>
+	CallText& operator<<(const T& value)
+	{
+		Append(&value, &FormatValue<T>);
+		return *this ;
+	}
+	void Append(const void* value, Format format) ;
+	std::string Str() const
+	{
+		return m_text + ")" ;
+	}
+private:
+	std::string m_text ;
+	size_t m_arguments ;
+};
+
+// Base of mocks with non-virtual methods, for dependencies that are injected
+// as template parameters. Each mocked method forwards to a StaticMethod
+// member, so matching and dispatch are resolved at compile time and can be
+// inlined; verification, reporting, soft-fail collection and Reset() are
+// those of Mock, and the mock is created through MockRepository as usual.
+//
+//	class ClockMock : public TinyMock::StaticMock<ClockMock>
+//	{
+//	public:
+//		ClockMock(const std::string& className) : StaticMock<ClockMock>(className), now(*this, "Now") {}
+//		int Now() { return now(); }
+//		TinyMock::StaticMethod<ClockMock, int()> now ;
+//	};
+//
+//	clock->now.Expect().Returns(10);
+//
+// Arguments are compared with operator==; Derived can hide Matches() to
+// compare them differently.
+template <typename Derived>
+class StaticMock : public Mock
+{
+public:
+	StaticMock(const std::string& className) : Mock(className) {}
+
+	template <typename Expected, typename Actual>
+	static bool Matches(const Expected& expected, const Actual& actual)
+	{
+		return expected == actual ;
+	}
+
+	// Used by StaticMethod.
+	void Attach(ExpectationSource* source)
+	{
+		m_expectations.AddSource(source);
+	}
+	void Registered()
+	{
+		m_expectations.Registered();
+	}
+	void Consumed()
+	{
+		m_expectations.Consumed(1);
+	}
+	using Mock::IsIgnored ;
+	using Mock::ReportNotExpected ;
+	using Mock::ReportExpectedAndActualDifferent ;
+	using Mock::CheckOrder ;
+	using Mock::CountCall ;
+};
+
+template <typename R>
+class StaticResult
+{
+public:
+	StaticResult() : m_value() {}
+	R Value() const
+	{
+		return m_value ;
+	}
+protected:
+	R m_value ;
+};
+
+template <>
+class StaticResult<void>
+{
+public:
+	void Value() const {}
+};
+
+template <typename R, typename... Args>
+class StaticExpectation : public StaticResult<R>
+{
+public:
+	typedef std::tuple<typename std::decay<Args>::type...> Arguments_t ;
+	StaticExpectation() : m_ignoreArguments(false), m_sequence(NULL), m_position(0), m_notifier(NULL) {}
+	StaticExpectation(const Arguments_t& arguments) : m_arguments(arguments), m_ignoreArguments(false), m_sequence(NULL), m_position(0), m_notifier(NULL) {}
+	template <typename V>
+	StaticExpectation& Returns(const V& value)
+	{
+		this->m_value = value ;
+		return *this ;
+	}
+	StaticExpectation& ignoreArguments()
+	{
+		m_ignoreArguments = true ;
+		return *this ;
+	}
+	// Sent when the expected call is matched.
+	StaticExpectation& AddNotifier(TinyNotifier* notifier)
+	{
+		m_notifier = notifier ;
+		return *this ;
+	}
+	TinyNotifier* Notifier() const
+	{
+		return m_notifier ;
+	}
+	const Arguments_t& Arguments() const
+	{
+		return m_arguments ;
+	}
+	bool IgnoresArguments() const
+	{
+		return m_ignoreArguments ;
+	}
+	void PlaceInSequence(Sequence* sequence, size_t position)
+	{
+		m_sequence = sequence ;
+		m_position = position ;
+	}
+	Sequence* InSequence() const
+	{
+		return m_sequence ;
+	}
+	size_t PositionInSequence() const
+	{
+		return m_position ;
+	}
+private:
+	Arguments_t m_arguments ;
+	bool m_ignoreArguments ;
+	Sequence* m_sequence ;
+	size_t m_position ;
+	TinyNotifier* m_notifier ;
+};
+
+template <typename Tuple, size_t... I>
+void AppendArguments(CallText& text, const Tuple& arguments, std::index_sequence<I...>)
+{
+	int expand[] = { 0, (text << std::get<I>(arguments), 0)... };
+	(void)expand ;
+}
+
+template <typename Derived, typename Signature>
+class StaticMethod ;
+
+// A mocked method of a StaticMock: a typed FIFO of expected calls, stored by
+// value. Only violations are formatted.
+template <typename Derived, typename R, typename... Args>
+class StaticMethod<Derived, R(Args...)> : public ExpectationSource
+{
+public:
+	typedef StaticExpectation<R, Args...> Expectation_t ;
+
+	StaticMethod(StaticMock<Derived>& mock, const std::string& name) : m_mock(mock), m_name(name)
+	{
+		m_mock.Attach(this);
+	}
+
+	Expectation_t& Expect(const typename std::decay<Args>::type&... arguments)
+	{
+		m_expected.push_back(Expectation_t(typename Expectation_t::Arguments_t(arguments...)));
+		m_mock.Registered();
+		return m_expected.back();
+	}
+
+	// Expects the call at the next position of 'sequence'.
+	Expectation_t& Expect(Sequence& sequence, const typename std::decay<Args>::type&... arguments)
+	{
+		Expectation_t& expected = Expect(arguments...);
+		expected.PlaceInSequence(&sequence, sequence.Enlist(m_mock.ClassName() + "::" + ToString(expected.Arguments())));
+		return expected ;
+	}
+
+	R operator()(const typename std::decay<Args>::type&... arguments)
+	{
+		m_mock.CountCall(m_name);
+		if(m_mock.IsIgnored(m_name))
+		{
+			return R();
+		}
+		if(m_expected.empty())
+		{
+			m_mock.ReportNotExpected(ToString(std::tie(arguments...)));
+			return R();
+		}
+		// The slot stays valid until the next Expect().
+		Expectation_t& expected = m_expected.front();
+		m_expected.pop_front();
+		m_mock.Consumed();
+		if(!expected.IgnoresArguments() && !Derived::Matches(expected.Arguments(), std::tie(arguments...)))
+		{
+			m_mock.ReportExpectedAndActualDifferent(ToString(expected.Arguments()), ToString(std::tie(arguments...)));
+			return R();
+		}
+		if(expected.InSequence())
+		{
+			m_mock.CheckOrder(*expected.InSequence(), expected.PositionInSequence());
+		}
+		if(expected.Notifier())
+		{
+			expected.Notifier()->Send();
+		}
+		return expected.Value();
+	}
+
+	size_t Pending() const
+	{
+		return m_expected.size();
+	}
+	std::string Signature() const
+	{
+		std::string signature = std::string() + typeid(R).name() + " " + m_name + "(" ;
+		const char* separator = "" ;
+		int expand[] = { 0, ((signature += separator, signature += typeid(Args).name()), separator = ",", 0)... };
+		(void)expand ;
+		(void)separator ;
+		return signature + ")" ;
+	}
+	void PrintPending(std::ostream& os, const std::string& className) const
+	{
+		for(size_t e = 0; e < m_expected.size(); ++e)
+		{
+			os << className << "::" << ToString(m_expected[e].Arguments()) << std::endl ;
+		}
+	}
+	void Clear()
+	{
+		m_expected.clear();
+	}
+
+private:
+	StaticMock<Derived>& m_mock ;
+	std::string m_name ;
+	RingQueue<Expectation_t> m_expected ;
+
+	template <typename Tuple>
+	std::string ToString(const Tuple& arguments) const
+	{
+		CallText text(m_name);
+		AppendArguments(text, arguments, std::make_index_sequence<std::tuple_size<Tuple>::value>());
+		return text.Str();
+	}
+};
+
+// Makes the expected calls of one method on demand: the n-th expected call
+// is a copy of the prototype that 'expect' fills in, e.g. sets the argument
+// to f(n). Consumed expectations are recycled, so any number of calls runs
+// in constant memory. The calls not yet made count as outstanding and are
+// reported, with the next one, when the mock is verified.
+//
+//	TinyMock::ExpectationGenerator<Method<int,void,void,void,void> > writes(
+//		Method<int,void,void,void,void>("Write",0), 100000000,
+//		[](uint64_t n, Method<int,void,void,void,void>& expected) { expected.m_p1 = n % 256; });
+//	mock->AddExpectationSource(&writes);
+template <typename M>
+class ExpectationGenerator : public ExpectationSource, public MethodRecycler
+{
+public:
+	typedef std::function<void(unsigned long long call, M& expected)> Expect_t ;
+
+	ExpectationGenerator(const M& prototype, unsigned long long calls, const Expect_t& expect)
+		: m_prototype(prototype), m_signature(m_prototype.Signature()), m_calls(calls), m_made(0), m_expect(expect) {}
+	~ExpectationGenerator()
+	{
+		for(size_t i = 0; i < m_pool.size(); ++i)
+		{
+			delete m_pool[i];
+		}
+	}
+
+	bool Supply(const std::string& signature, Expectations& expectations)
+	{
+		if(m_made == m_calls || signature != m_signature)
+		{
+			return false ;
+		}
+		M* expected = NULL ;
+		if(m_free.empty())
+		{
+			expected = new M(m_prototype);
+			expected->RecycleWith(this);
+			m_pool.push_back(expected);
+		}
+		else
+		{
+			expected = m_free.back();
+			m_free.pop_back();
+		}
+		m_expect(m_made++, *expected);
+		expectations.Materialise(m_signature, expected);
+		return true ;
+	}
+	void Recycle(BaseMethod* method)
+	{
+		m_free.push_back(static_cast<M*>(method));
+	}
+
+	size_t Pending() const
+	{
+		return m_calls - m_made ;
+	}
+	std::string Signature() const
+	{
+		return m_signature ;
+	}
+	void PrintPending(std::ostream& os, const std::string& className) const
+	{
+		if(Pending())
+		{
+			M next(m_prototype);
+			m_expect(m_made, next);
+			os << className << "::" << next.ToString() << " is call " << m_made + 1 << " of " << m_calls << " expected" << std::endl ;
+		}
+	}
+	void Clear()
+	{
+		m_made = m_calls ;
+	}
+	// The number of expectations the generator holds.
+	size_t Allocated() const
+	{
+		return m_pool.size();
+	}
+private:
+	M m_prototype ;
+	std::string m_signature ;
+	unsigned long long m_calls ;
+	unsigned long long m_made ;
+	Expect_t m_expect ;
+	std::vector<M*> m_pool ;
+	std::vector<M*> m_free ;
+};
+
+// The descriptor of the Method type M, which returns R and takes P...; M
+// tells where the arguments are with Argument().
+template <typename M, typename R, typename... P>
+struct MethodDescriptorOf
+{
+	static const MethodDescriptor table ;
+};
+
+template <typename M, typename R, typename... P>
+const MethodDescriptor MethodDescriptorOf<M,R,P...>::table =
+	{ &typeid(R), false, sizeof...(P), { &typeid(P)... }, { &FormatValue<typename std::remove_reference<P>::type>... }, &M::Argument };
+
+// The descriptor of a method that takes any arguments and returns R.
+template <typename R>
+struct AnyArgumentsDescriptorOf
+{
+	static const MethodDescriptor table ;
+};
+
+template <typename R>
+const MethodDescriptor AnyArgumentsDescriptorOf<R>::table = { &typeid(R), true, 0, {}, {}, NULL };
+
+template < typename P1, typename P2, typename P3, typename P4, typename R>
+class Method : public BaseMethod
+{
+public:
+	Method(const std::string& name, P1 p1, P2 p2, P3 p3, P4 p4, R r) : 
+		BaseMethod(name, &MethodDescriptorOf<Method,R,P1,P2,P3,P4>::table), m_p1(p1), m_p2(p2), m_p3(p3), m_p4(p4), m_r(r) {}
+	Method(const Method<P1,P2,P3,P4,R>& method) :
+		BaseMethod(method.m_name, &MethodDescriptorOf<Method,R,P1,P2,P3,P4>::table), m_p1(method.m_p1), m_p2(method.m_p2), m_p3(method.m_p3), m_p4(method.m_p4), m_r(method.m_r)
+	{		
+	}
+	virtual ~Method()
+	{
+	}
+	virtual BaseMethod* CopyInstance()
+	{
+		return new Method<P1,P2,P3,P4,R>(*this);
+	}	
+	virtual bool operator==(const BaseMethod& op)
+	{
+		if(m_ignoreArguments) return true ;
+		// Do not compare the return value !!!
+		const Method<P1,P2,P3,P4,R>& opCast = (const Method<P1,P2,P3,P4,R>&)op;
+		return ((m_p1 == opCast.m_p1) && (m_p2 == opCast.m_p2) && (m_p3 == opCast.m_p3) && (m_p4 == opCast.m_p4));
+	}	
+	static const void* Argument(const BaseMethod& method, size_t index)
+	{
+		const Method& self = static_cast<const Method&>(method);
+		const void* arguments[] = { &self.m_p1, &self.m_p2, &self.m_p3, &self.m_p4 };
+		return arguments[index];
+	}
+	P1 m_p1;
+	P2 m_p2;
+	P3 m_p3;
+    P4 m_p4;
+	R m_r ;
+};
+
+template < typename P1, typename P2, typename P3, typename P4 >
+class Method<P1,P2,P3,P4,void> : public BaseMethod
+{
+public:
+	Method(const std::string& name, P1 p1, P2 p2, P3 p3, P4 p4) : 
+		BaseMethod(name, &MethodDescriptorOf<Method,void,P1,P2,P3,P4>::table), m_p1(p1), m_p2(p2), m_p3(p3), m_p4(p4) {}
+	Method(const Method<P1,P2,P3,P4,void>& method) :
+		BaseMethod(method.m_name, &MethodDescriptorOf<Method,void,P1,P2,P3,P4>::table), m_p1(method.m_p1), m_p2(method.m_p2), m_p3(method.m_p3), m_p4(method.m_p4)
+	{		
+	}
+	virtual ~Method()
+	{
+	}
+	virtual BaseMethod* CopyInstance()
+	{
+		return new Method<P1,P2,P3,P4,void>(*this);
+	}
+	virtual bool operator==(const BaseMethod& op)
+	{
+		if(m_ignoreArguments) return true ;
+		// Do not compare the return value !!!
+		const Method<P1,P2,P3,P4,void>& opCast = (const Method<P1,P2,P3,P4,void>&)op;
+		return ((m_p1 == opCast.m_p1) && (m_p2 == opCast.m_p2) && (m_p3 == opCast.m_p3) && (m_p4 == opCast.m_p4));
+	}	
+	static const void* Argument(const BaseMethod& method, size_t index)
+	{
+		const Method& self = static_cast<const Method&>(method);
+		const void* arguments[] = { &self.m_p1, &self.m_p2, &self.m_p3, &self.m_p4 };
+		return arguments[index];
+	}
+	P1 m_p1;
+	P2 m_p2;
+	P3 m_p3;
+    P4 m_p4;
+};
+
+template < typename P1, typename P2, typename P3, typename R>
+class Method<P1,P2,P3,void,R> : public BaseMethod
+{
+public:
+	Method(const std::string& name, P1 p1, P2 p2, P3 p3, R r) : 
+		BaseMethod(name, &MethodDescriptorOf<Method,R,P1,P2,P3>::table), m_p1(p1), m_p2(p2), m_p3(p3), m_r(r) {}
+	Method(const Method<P1,P2,P3,void,R>& method) :
+		BaseMethod(method.m_name, &MethodDescriptorOf<Method,R,P1,P2,P3>::table), m_p1(method.m_p1), m_p2(method.m_p2), m_p3(method.m_p3), m_r(method.m_r)
+	{		
+	}
+	virtual ~Method()
+	{
+	}
+	virtual BaseMethod* CopyInstance()
+	{
+		return new Method<P1,P2,P3,void,R>(*this);
+	}	
+	virtual bool operator==(const BaseMethod& op)
+	{
+		if(m_ignoreArguments) return true ;
+		// Do not compare the return value !!!
+		const Method<P1,P2,P3,void,R>& opCast = (const Method<P1,P2,P3,void,R>&)op;
+		return ((m_p1 == opCast.m_p1) && (m_p2 == opCast.m_p2) && (m_p3 == opCast.m_p3));
+	}	
+	static const void* Argument(const BaseMethod& method, size_t index)
+	{
+		const Method& self = static_cast<const Method&>(method);
+		const void* arguments[] = { &self.m_p1, &self.m_p2, &self.m_p3 };
+		return arguments[index];
+	}
+	P1 m_p1;
+	P2 m_p2;
+	P3 m_p3;
+	R m_r ;
+};
+
+template < typename P1, typename P2, typename P3>
+class Method<P1,P2,P3,void,void> : public BaseMethod
+{
+public:
+	Method(const std::string& name, P1 p1, P2 p2, P3 p3) : 
+		BaseMethod(name, &MethodDescriptorOf<Method,void,P1,P2,P3>::table), m_p1(p1), m_p2(p2), m_p3(p3) {}
+	Method(const Method<P1,P2,P3,void,void>& method) :
+		BaseMethod(method.m_name, &MethodDescriptorOf<Method,void,P1,P2,P3>::table), m_p1(method.m_p1), m_p2(method.m_p2),m_p3(method.m_p3)
+	{		
+	}
+	virtual ~Method()
+	{
+	}	
+	virtual bool operator==(const BaseMethod& op)
+	{
+		if(m_ignoreArguments) return true ;
+		// Do not compare the return value !!!
+		const Method<P1,P2,P3,void,void>& opCast = (const Method<P1,P2,P3,void,void>&)op;
+		return ((m_p1 == opCast.m_p1) && (m_p2 == opCast.m_p2) && (m_p3 == opCast.m_p3));
+	}	
+	static const void* Argument(const BaseMethod& method, size_t index)
+	{
+		const Method& self = static_cast<const Method&>(method);
+		const void* arguments[] = { &self.m_p1, &self.m_p2, &self.m_p3 };
+		return arguments[index];
+	}
+	P1 m_p1;
+	P2 m_p2;
+	P3 m_p3;	
+};
+
+template < typename P1, typename P2, typename R>
+class Method<P1,P2,void,void,R> : public BaseMethod
+{
+public:
+	Method(const std::string& name, P1 p1, P2 p2, R r) : 
+		BaseMethod(name, &MethodDescriptorOf<Method,R,P1,P2>::table), m_p1(p1), m_p2(p2), m_r(r) {}
+	Method(const Method<P1,P2,void,void,R>& method) :
+		BaseMethod(method.m_name, &MethodDescriptorOf<Method,R,P1,P2>::table), m_p1(method.m_p1), m_p2(method.m_p2), m_r(method.m_r)
+	{		
+	}
+	virtual ~Method()
+	{
+	}
+	virtual BaseMethod* CopyInstance()
+	{
+		return new Method<P1,P2,void,void,R>(*this);
+	}	
+	virtual bool operator==(const BaseMethod& op)
+	{
+		if(m_ignoreArguments) return true ;
+		// Do not compare the return value !!!
+		const Method<P1,P2,void,void,R>& opCast = (const Method<P1,P2,void,void,R>&)op;
+		return ((m_p1 == opCast.m_p1) && (m_p2 == opCast.m_p2));
+	}	
+	static const void* Argument(const BaseMethod& method, size_t index)
+	{
+		const Method& self = static_cast<const Method&>(method);
+		const void* arguments[] = { &self.m_p1, &self.m_p2 };
+		return arguments[index];
+	}
+	P1 m_p1;
+	P2 m_p2;
+	R m_r ;
+};
+
+template < typename P1, typename P2>
+class Method<P1,P2,void,void,void> : public BaseMethod
+{
+public:
+	Method(const std::string& name, P1 p1, P2 p2) : 
+		BaseMethod(name, &MethodDescriptorOf<Method,void,P1,P2>::table), m_p1(p1), m_p2(p2) {}
+	Method(const Method<P1,P2,void,void,void>& method) :
+		BaseMethod(method.m_name, &MethodDescriptorOf<Method,void,P1,P2>::table), m_p1(method.m_p1), m_p2(method.m_p2)
+	{		
+	}
+	virtual ~Method()
+	{
+	}
+	virtual BaseMethod* CopyInstance()
+	{
+		return new Method<P1,P2,void,void,void>(*this);
+	}	
+	virtual bool operator==(const BaseMethod& op)
+	{
+		if(m_ignoreArguments) return true ;
+		// Do not compare the return value !!!
+		const Method<P1,P2,void,void,void>& opCast = (const Method<P1,P2,void,void,void>&)op;
+		return ((m_p1 == opCast.m_p1) && (m_p2 == opCast.m_p2));
+	}	
+	static const void* Argument(const BaseMethod& method, size_t index)
+	{
+		const Method& self = static_cast<const Method&>(method);
+		const void* arguments[] = { &self.m_p1, &self.m_p2 };
+		return arguments[index];
+	}
+	P1 m_p1;
+	P2 m_p2;
+};
+
+template < typename P1, typename R>
+class Method<P1,void,void,void,R> : public BaseMethod
+{
+public:
+	Method(const std::string& name, P1 p1, R r) : 
+		BaseMethod(name, &MethodDescriptorOf<Method,R,P1>::table), m_p1(p1), m_r(r) {}
+	Method(const Method<P1,void,void,void,R>& method) :
+		BaseMethod(method.m_name, &MethodDescriptorOf<Method,R,P1>::table), m_p1(method.m_p1), m_r(method.m_r)
+	{		
+	}
+	virtual ~Method()
+	{
+	}
+	virtual bool operator==(const BaseMethod& op)
+	{
+		if(m_ignoreArguments) return true ;
+		// Do not compare the return value !!!
+		const Method<P1,void,void,void,R>& opCast = (const Method<P1,void,void,void,R>&)op;
+		return (m_p1 == opCast.m_p1);
+	}	
+	static const void* Argument(const BaseMethod& method, size_t index)
+	{
+		const Method& self = static_cast<const Method&>(method);
+		const void* arguments[] = { &self.m_p1 };
+		return arguments[index];
+	}
+	P1 m_p1;	
+	R m_r ;
+};
+
+template < typename P1>
+class Method<P1,void,void,void,void> : public BaseMethod
+{
+public:
+	Method(const std::string& name, P1 p1) : 
+		BaseMethod(name, &MethodDescriptorOf<Method,void,P1>::table), m_p1(p1) {}
+	Method(const Method<P1,void,void,void,void>& method) :
+		BaseMethod(method.m_name, &MethodDescriptorOf<Method,void,P1>::table), m_p1(method.m_p1)
+	{		
+	}
+	virtual ~Method()
+	{
+	}
+	virtual bool operator==(const BaseMethod& op)
+	{
+		if(m_ignoreArguments) return true ;
+		// Do not compare the return value !!!
+		const Method<P1,void,void,void,void>& opCast = (const Method<P1,void,void,void,void>&)op;
+		return (m_p1 == opCast.m_p1);		
+	}	
+	static const void* Argument(const BaseMethod& method, size_t index)
+	{
+		const Method& self = static_cast<const Method&>(method);
+		const void* arguments[] = { &self.m_p1 };
+		return arguments[index];
+	}
+	P1 m_p1;		
+};
+
+template < typename R>
+class Method<void,void,void,void,R> : public BaseMethod
+{
+public:
+	Method(const std::string& name,R r) : 
+		BaseMethod(name, &MethodDescriptorOf<Method,R>::table), m_r(r) {}
+	Method(const Method<void,void,void,void,R>& method) :
+		BaseMethod(method.m_name, &MethodDescriptorOf<Method,R>::table), m_r(method.m_r)
+	{		
+	}
+	virtual ~Method()
+	{
+	}
+	virtual bool operator==(const BaseMethod& op)
+	{
+		if(m_ignoreArguments) return true ;
+		// Do not compare the return value !!!		
+		return true;
+	}	
+	R m_r ;
+};
+
+template <>
+class Method<void,void,void,void,void> : public BaseMethod
+{
+public:
+	Method(const std::string& name) : 
+		BaseMethod(name, &MethodDescriptorOf<Method,void>::table) {}
+	Method(const Method<void,void,void,void,void>& method) :
+		BaseMethod(method.m_name, &MethodDescriptorOf<Method,void>::table)
+	{		
+	}
+	virtual ~Method()
+	{
+	}
+	virtual bool operator==(const BaseMethod& op)
+	{		
+		return true;
+	}	
+};
+
+template < typename R>
+class MethodIgnoringArguments : public BaseMethod
+{
+public:
+	MethodIgnoringArguments(const std::string& name, R r) : 
+		BaseMethod(name, &AnyArgumentsDescriptorOf<R>::table), m_r(r) {}
+	MethodIgnoringArguments(const MethodIgnoringArguments<R>& method) :
+		BaseMethod(method.m_name, &AnyArgumentsDescriptorOf<R>::table), m_r(method.m_r)
+	{		
+	}
+	virtual ~MethodIgnoringArguments()
+	{
+	}
+	virtual bool operator==(const BaseMethod& op)
+	{
+		// Do not compare the return value !!!
+		// Do not compare arguments !!!		
+		return true;
+	}	
+	R m_r;		
+};
+
+template <>
+class MethodIgnoringArguments<void> : public BaseMethod
+{
+public:
+	MethodIgnoringArguments(const std::string& name) : 
+		BaseMethod(name, &AnyArgumentsDescriptorOf<void>::table) {}
+	MethodIgnoringArguments(const MethodIgnoringArguments<void>& method) :
+		BaseMethod(method.m_name, &AnyArgumentsDescriptorOf<void>::table)
+	{		
+	}
+	virtual ~MethodIgnoringArguments()
+	{
+	}
+	virtual bool operator==(const BaseMethod& op)
+	{
+		// Do not compare the return value !!!
+		// Do not compare arguments !!!	
+		return true;
+	}	
+};
+
+
+template < typename P1, typename P2, typename P3, typename P4, typename R>
+class MethodWithDereferencedArguments : public BaseMethod
+{
+public:
+	MethodWithDereferencedArguments(const std::string& name, P1 p1, P2 p2, P3 p3, P4 p4, R r) : 
+		BaseMethod(name, &MethodDescriptorOf<MethodWithDereferencedArguments,R,P1,P2,P3,P4>::table), m_p1(p1), m_p2(p2), m_p3(p3), m_p4(p4), m_r(r) {}
+	MethodWithDereferencedArguments(const MethodWithDereferencedArguments<P1,P2,P3,P4,R>& method) :
+		BaseMethod(method.m_name, &MethodDescriptorOf<MethodWithDereferencedArguments,R,P1,P2,P3,P4>::table), m_p1(method.m_p1), m_p2(method.m_p2), m_p3(method.m_p3), m_p4(method.m_p4), m_r(method.m_r)
+	{		
+	}
+	virtual ~MethodWithDereferencedArguments()
+	{
+	}
+	virtual BaseMethod* CopyInstance()
+	{
+		return new MethodWithDereferencedArguments<P1,P2,P3,P4,R>(*this);
+	}
+	//bool operator==(const Method<P1,P2,P3,R>& op)
+	virtual bool operator==(const BaseMethod& op)
+	{
+		// Do not compare the return value !!!
+		const MethodWithDereferencedArguments<P1,P2,P3,P4,R>& opCast = (const MethodWithDereferencedArguments<P1,P2,P3,P4,R>&)op;
+		return ((*m_p1 == *(opCast.m_p1)) && (*m_p2 == *(opCast.m_p2)) && (*m_p3 == *(opCast.m_p3)) && (*m_p4 == *(opCast.m_p4)));
+	}	
+	static const void* Argument(const BaseMethod& method, size_t index)
+	{
+		const MethodWithDereferencedArguments& self = static_cast<const MethodWithDereferencedArguments&>(method);
+		const void* arguments[] = { &self.m_p1, &self.m_p2, &self.m_p3, &self.m_p4 };
+		return arguments[index];
+	}
+	P1 m_p1;
+	P2 m_p2;
+	P3 m_p3;
+    P4 m_p4;
+	R m_r ;
+};
+
+template < typename P1>
+class MethodWithDereferencedArguments<P1,void,void,void,void> : public BaseMethod
+{
+public:
+	MethodWithDereferencedArguments(const std::string& name, P1 p1) : 
+		BaseMethod(name, &s_descriptor), m_p1(p1) {}
+	MethodWithDereferencedArguments(const MethodWithDereferencedArguments<P1,void,void,void,void>& method) :
+		BaseMethod(method.m_name, &s_descriptor), m_p1(method.m_p1)
+	{		
+	}
+	virtual ~MethodWithDereferencedArguments()
+	{
+	}
+	virtual bool operator==(const BaseMethod& op)
+	{
+		// Do not compare the return value !!!
+		const MethodWithDereferencedArguments<P1,void,void,void,void>& opCast = (const MethodWithDereferencedArguments<P1,void,void,void,void>&)op;
+		return (*m_p1 == *(opCast.m_p1));		
+	}	
+	static const void* Argument(const BaseMethod& method, size_t)
+	{
+		return &*static_cast<const MethodWithDereferencedArguments&>(method).m_p1 ;
+	}
+	static const MethodDescriptor s_descriptor ;
+	P1 m_p1;		
+};
+
+// The argument is shown dereferenced.
+template < typename P1>
+const MethodDescriptor MethodWithDereferencedArguments<P1,void,void,void,void>::s_descriptor =
+	{ &typeid(void), false, 1, { &typeid(P1) }, { &FormatValue<typename std::remove_reference<decltype(*std::declval<P1>())>::type> }, &MethodWithDereferencedArguments::Argument };
+
+// Method types common enough to be compiled once, into the TinyMock library,
+// when TINYMOCK_LEAN is defined.
+#define TINYMOCK_COMMON_METHODS(X) \
+	X(Method<int,void,void,void,void>) \
+	X(Method<bool,void,void,void,void>) \
+	X(Method<std::string,void,void,void,void>) \
+	X(Method<int,int,void,void,void>) \
+	X(Method<void,void,void,void,int>) \
+	X(Method<void,void,void,void,bool>) \
+	X(Method<void,void,void,void,std::string>) \
+	X(Method<int,void,void,void,int>) \
+	X(MethodIgnoringArguments<int>) \
+	X(MethodIgnoringArguments<bool>)
+
+#ifdef TINYMOCK_LEAN
+#define TINYMOCK_EXTERN_METHOD(...) extern template class __VA_ARGS__ ;
+TINYMOCK_COMMON_METHODS(TINYMOCK_EXTERN_METHOD)
+#undef TINYMOCK_EXTERN_METHOD
+#endif
+
+}
+
+#endif
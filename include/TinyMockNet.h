@@ -0,0 +1,566 @@
+#ifndef TINYMOCKNET_H
+#define TINYMOCKNET_H
+
+/*
+A loopback stand-in server scripted with expectations.
+
+StandInServer is a StaticMock that listens on 127.0.0.1 for TCP connections
+and UDP datagrams. Every request it receives is a call of its method
+'request', and the expectation met returns the response: the bytes to send
+back, how long to wait before sending them, or a reset of the connection
+instead.
+
+	StandInServer* server = repository.CreateMock<StandInServer,ConcreteNotifier>("Server");
+	server->request.Expect("GET a\n").Returns("200 a\n");
+	server->request.Expect("GET b\n").Returns(StandInResponse("200 b\n").After(50));
+	server->request.Expect("GET c\n").Returns(StandInResponse::Reset());
+	server->Start();
+	... clients connect to server->TcpPort() ...
+	server->Stop();
+	repository.verifyAll();
+
+A TCP request ends with a newline, unless Frame() says otherwise; a
+datagram is a request. The responses of a connection go out in the order
+of its requests, and a delayed one holds back those after it, as with a
+pipelining server. An unexpected request is a violation and gets no
+response.
+
+Between Start() and Stop() the server runs an epoll loop on a thread of its
+own. Register expectations and verify the mock while it is stopped. The
+requests of all the connections meet the expectations in the order in which
+they arrive.
+*/
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <linux/sockios.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <map>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "TinyMock.h"
+
+namespace TinyMock {
+
+class StandInError : public std::exception
+{
+public:
+	StandInError(const std::string& message) : m_message(message) {}
+	virtual ~StandInError() throw() {}
+	virtual const char* what() const throw()
+	{
+		return m_message.c_str();
+	}
+private:
+	std::string m_message ;
+};
+
+struct StandInResponse
+{
+	StandInResponse() : delay(0), reset(false) {}
+	StandInResponse(const std::string& bytes) : bytes(bytes), delay(0), reset(false) {}
+	StandInResponse(const char* bytes) : bytes(bytes), delay(0), reset(false) {}
+	// Sent 'milliseconds' after the request.
+	StandInResponse& After(unsigned milliseconds)
+	{
+		delay = milliseconds ;
+		return *this ;
+	}
+	// Resets the connection instead of answering; a datagram gets no answer.
+	static StandInResponse Reset()
+	{
+		StandInResponse response ;
+		response.reset = true ;
+		return response ;
+	}
+	std::string bytes ;
+	unsigned delay ;
+	bool reset ;
+};
+
+class StandInServer : public StaticMock<StandInServer>
+{
+public:
+	// The size of the first request in 'size' bytes received, 0 while it is
+	// incomplete.
+	typedef std::function<size_t(const char* data, size_t size)> Framing_t ;
+
+	StandInServer(const std::string& className)
+		: StaticMock<StandInServer>(className), request(*this, "request"), m_framing(&Lines),
+		  m_epoll(-1), m_listener(-1), m_datagrams(-1), m_wake(-1), m_tcpPort(0), m_udpPort(0),
+		  m_stopping(false), m_connections(0), m_requests(0)
+	{
+	}
+	~StandInServer()
+	{
+		Shutdown();
+	}
+
+	static size_t Lines(const char* data, size_t size)
+	{
+		const void* end = memchr(data, '\n', size);
+		return end ? static_cast<const char*>(end) - data + 1 : 0 ;
+	}
+	void Frame(const Framing_t& framing)
+	{
+		m_framing = framing ;
+	}
+
+	// Listens on the ports of the previous start, if any.
+	void Start()
+	{
+		if(m_thread.joinable())
+		{
+			return ;
+		}
+		try
+		{
+			m_epoll = Check(epoll_create1(EPOLL_CLOEXEC), "epoll_create1");
+			m_wake = Check(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC), "eventfd");
+			m_listener = Bind(SOCK_STREAM, m_tcpPort);
+			Check(listen(m_listener, SOMAXCONN), "listen");
+			m_datagrams = Bind(SOCK_DGRAM, m_udpPort);
+			Watch(m_wake, EPOLLIN);
+			Watch(m_listener, EPOLLIN);
+			Watch(m_datagrams, EPOLLIN);
+		}
+		catch(...)
+		{
+			Shutdown();
+			throw ;
+		}
+		m_stopping = false ;
+		m_connections = 0 ;
+		m_requests = 0 ;
+		m_thread = std::thread(&StandInServer::Loop, this);
+	}
+	// Closes all the connections; rethrows what stopped the loop, e.g. a
+	// failure notifier that throws.
+	void Stop()
+	{
+		Shutdown();
+		if(m_error)
+		{
+			std::exception_ptr error = m_error ;
+			m_error = std::exception_ptr();
+			std::rethrow_exception(error);
+		}
+	}
+
+	unsigned short TcpPort() const
+	{
+		return m_tcpPort ;
+	}
+	unsigned short UdpPort() const
+	{
+		return m_udpPort ;
+	}
+	// TCP connections accepted and requests received since Start().
+	size_t Connections() const
+	{
+		return m_connections.load();
+	}
+	size_t Requests() const
+	{
+		return m_requests.load();
+	}
+
+	StaticMethod<StandInServer, StandInResponse(std::string)> request ;
+
+private:
+	typedef std::chrono::steady_clock Clock ;
+
+	struct Pending
+	{
+		Clock::time_point due ;
+		std::string bytes ;
+		bool reset ;
+	};
+	typedef std::multimap<Clock::time_point, int> Delayed_t ;
+	struct Connection
+	{
+		Connection() : writing(false), scheduled(false) {}
+		std::string received ;
+		std::string unsent ;
+		std::deque<Pending> pending ;
+		bool writing ;
+		// whether 'delayed' is its entry in m_delayed
+		bool scheduled ;
+		Delayed_t::iterator delayed ;
+	};
+	struct Datagram
+	{
+		sockaddr_in to ;
+		std::string bytes ;
+	};
+
+	Framing_t m_framing ;
+	int m_epoll ;
+	int m_listener ;
+	int m_datagrams ;
+	int m_wake ;
+	unsigned short m_tcpPort ;
+	unsigned short m_udpPort ;
+	std::thread m_thread ;
+	std::exception_ptr m_error ;
+	std::atomic<bool> m_stopping ;
+	std::atomic<size_t> m_connections ;
+	std::atomic<size_t> m_requests ;
+	std::map<int, Connection> m_clients ;
+	// connections by the time their next response is due
+	Delayed_t m_delayed ;
+	std::multimap<Clock::time_point, Datagram> m_delayedDatagrams ;
+	std::vector<char> m_buffer ;
+
+	static int Check(int result, const char* call)
+	{
+		if(result < 0)
+		{
+			throw StandInError(std::string(call) + ": " + strerror(errno));
+		}
+		return result ;
+	}
+	int Bind(int type, unsigned short& port)
+	{
+		const int fd = Check(socket(AF_INET, type | SOCK_NONBLOCK | SOCK_CLOEXEC, 0), "socket");
+		const int on = 1 ;
+		setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof on);
+		sockaddr_in address ;
+		memset(&address, 0, sizeof address);
+		address.sin_family = AF_INET ;
+		address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		address.sin_port = htons(port);
+		socklen_t length = sizeof address ;
+		if(bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof address) < 0
+		   || getsockname(fd, reinterpret_cast<sockaddr*>(&address), &length) < 0)
+		{
+			const int error = errno ;
+			close(fd);
+			errno = error ;
+			Check(-1, "bind");
+		}
+		port = ntohs(address.sin_port);
+		return fd ;
+	}
+	void Watch(int fd, unsigned events, int operation = EPOLL_CTL_ADD)
+	{
+		epoll_event event ;
+		memset(&event, 0, sizeof event);
+		event.events = events ;
+		event.data.fd = fd ;
+		Check(epoll_ctl(m_epoll, operation, fd, &event), "epoll_ctl");
+	}
+	void Shutdown()
+	{
+		if(m_thread.joinable())
+		{
+			const uint64_t stop = 1 ;
+			if(write(m_wake, &stop, sizeof stop) < 0)
+			{
+				m_stopping = true ;
+			}
+			m_thread.join();
+		}
+		for(std::map<int, Connection>::iterator c = m_clients.begin(); c != m_clients.end(); ++c)
+		{
+			close(c->first);
+		}
+		m_clients.clear();
+		m_delayed.clear();
+		m_delayedDatagrams.clear();
+		const int fds[] = { m_listener, m_datagrams, m_wake, m_epoll };
+		for(size_t f = 0; f < sizeof fds / sizeof fds[0]; ++f)
+		{
+			if(fds[f] >= 0)
+			{
+				close(fds[f]);
+			}
+		}
+		m_listener = m_datagrams = m_wake = m_epoll = -1 ;
+	}
+
+	void Loop()
+	{
+		try
+		{
+			m_buffer.resize(65536);
+			epoll_event events[256];
+			while(!m_stopping)
+			{
+				const int ready = epoll_wait(m_epoll, events, 256, Timeout());
+				if(ready < 0 && errno != EINTR)
+				{
+					Check(ready, "epoll_wait");
+				}
+				for(int e = 0; e < ready; ++e)
+				{
+					Dispatch(events[e]);
+				}
+				SendDue();
+			}
+		}
+		catch(...)
+		{
+			m_error = std::current_exception();
+		}
+	}
+	void Dispatch(const epoll_event& event)
+	{
+		const int fd = event.data.fd ;
+		if(fd == m_wake)
+		{
+			m_stopping = true ;
+		}
+		else if(fd == m_listener)
+		{
+			Accept();
+		}
+		else if(fd == m_datagrams)
+		{
+			ReceiveDatagrams();
+		}
+		else
+		{
+			std::map<int, Connection>::iterator client = m_clients.find(fd);
+			if(client == m_clients.end())
+			{
+				return ;
+			}
+			if(event.events & (EPOLLERR | EPOLLHUP))
+			{
+				Close(fd, false);
+				return ;
+			}
+			if((event.events & EPOLLIN) && !Receive(fd, client->second))
+			{
+				return ;
+			}
+			if(event.events & EPOLLOUT)
+			{
+				Flush(fd, client->second);
+			}
+		}
+	}
+	// milliseconds until the next delayed response, -1 if there is none
+	int Timeout() const
+	{
+		bool any = !m_delayed.empty();
+		Clock::time_point next = any ? m_delayed.begin()->first : Clock::time_point();
+		if(!m_delayedDatagrams.empty() && (!any || m_delayedDatagrams.begin()->first < next))
+		{
+			next = m_delayedDatagrams.begin()->first ;
+			any = true ;
+		}
+		if(!any)
+		{
+			return -1 ;
+		}
+		const long long wait = std::chrono::duration_cast<std::chrono::milliseconds>(next - Clock::now()).count() + 1 ;
+		return wait > 0 ? int(wait) : 0 ;
+	}
+	void Accept()
+	{
+		for(;;)
+		{
+			const int fd = accept4(m_listener, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+			if(fd < 0)
+			{
+				return ;
+			}
+			const int on = 1 ;
+			setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof on);
+			Watch(fd, EPOLLIN);
+			m_clients[fd];
+			++m_connections ;
+		}
+	}
+	// false when the connection is gone
+	bool Receive(int fd, Connection& connection)
+	{
+		for(;;)
+		{
+			const ssize_t received = recv(fd, &m_buffer[0], m_buffer.size(), 0);
+			if(received > 0)
+			{
+				connection.received.append(&m_buffer[0], size_t(received));
+				if(size_t(received) < m_buffer.size())
+				{
+					break ;
+				}
+				continue ;
+			}
+			if(received < 0 && errno == EINTR)
+			{
+				continue ;
+			}
+			if(received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+			{
+				break ;
+			}
+			Close(fd, false);
+			return false ;
+		}
+		size_t framed = 0 ;
+		for(size_t size; framed < connection.received.size()
+		    && (size = m_framing(connection.received.data() + framed, connection.received.size() - framed)) != 0; framed += size)
+		{
+			Answer(connection, connection.received.substr(framed, size));
+		}
+		connection.received.erase(0, framed);
+		return Flush(fd, connection);
+	}
+	void Answer(Connection& connection, const std::string& bytes)
+	{
+		++m_requests ;
+		const StandInResponse response = request(bytes);
+		if(response.bytes.empty() && !response.reset)
+		{
+			return ;
+		}
+		Pending pending = { Clock::now() + std::chrono::milliseconds(response.delay), response.bytes, response.reset };
+		connection.pending.push_back(pending);
+	}
+	// Sends the responses that are due, in order; false when the connection
+	// is gone. A reset waits until the responses before it are sent.
+	bool Flush(int fd, Connection& connection)
+	{
+		const Clock::time_point now = Clock::now();
+		while(!connection.pending.empty() && connection.pending.front().due <= now && !connection.pending.front().reset)
+		{
+			connection.unsent += connection.pending.front().bytes ;
+			connection.pending.pop_front();
+		}
+		size_t sent = 0 ;
+		while(sent < connection.unsent.size())
+		{
+			const ssize_t written = send(fd, connection.unsent.data() + sent, connection.unsent.size() - sent, MSG_NOSIGNAL);
+			if(written < 0 && errno == EINTR)
+			{
+				continue ;
+			}
+			if(written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+			{
+				break ;
+			}
+			if(written < 0)
+			{
+				Close(fd, false);
+				return false ;
+			}
+			sent += size_t(written);
+		}
+		connection.unsent.erase(0, sent);
+		if(connection.unsent.empty() && !connection.pending.empty() && connection.pending.front().due <= now)
+		{
+			// A reset discards what the kernel has not sent yet: check again
+			// shortly until it has.
+			int queued = 0 ;
+			if(ioctl(fd, SIOCOUTQ, &queued) < 0 || queued == 0)
+			{
+				Close(fd, true);
+				return false ;
+			}
+			connection.pending.front().due = now + std::chrono::milliseconds(1);
+		}
+		Schedule(fd, connection);
+		const bool writing = !connection.unsent.empty();
+		if(writing != connection.writing)
+		{
+			Watch(fd, writing ? EPOLLIN | EPOLLOUT : EPOLLIN, EPOLL_CTL_MOD);
+			connection.writing = writing ;
+		}
+		return true ;
+	}
+	// Keeps the entry of the connection in m_delayed at the time its next
+	// response is due; a due reset waits for EPOLLOUT instead.
+	void Schedule(int fd, Connection& connection)
+	{
+		const bool waiting = !connection.pending.empty() && connection.unsent.empty();
+		if(connection.scheduled && (!waiting || connection.delayed->first != connection.pending.front().due))
+		{
+			m_delayed.erase(connection.delayed);
+			connection.scheduled = false ;
+		}
+		if(waiting && !connection.scheduled)
+		{
+			connection.delayed = m_delayed.insert(std::make_pair(connection.pending.front().due, fd));
+			connection.scheduled = true ;
+		}
+	}
+	void Close(int fd, bool reset)
+	{
+		if(reset)
+		{
+			const linger abort = { 1, 0 };
+			setsockopt(fd, SOL_SOCKET, SO_LINGER, &abort, sizeof abort);
+		}
+		close(fd);
+		std::map<int, Connection>::iterator client = m_clients.find(fd);
+		if(client->second.scheduled)
+		{
+			m_delayed.erase(client->second.delayed);
+		}
+		m_clients.erase(client);
+	}
+	void ReceiveDatagrams()
+	{
+		for(;;)
+		{
+			Datagram datagram ;
+			socklen_t length = sizeof datagram.to ;
+			const ssize_t received = recvfrom(m_datagrams, &m_buffer[0], m_buffer.size(), 0,
+				reinterpret_cast<sockaddr*>(&datagram.to), &length);
+			if(received < 0)
+			{
+				return ;
+			}
+			++m_requests ;
+			const StandInResponse response = request(std::string(&m_buffer[0], size_t(received)));
+			if(response.reset || response.bytes.empty())
+			{
+				continue ;
+			}
+			datagram.bytes = response.bytes ;
+			m_delayedDatagrams.insert(std::make_pair(Clock::now() + std::chrono::milliseconds(response.delay), datagram));
+		}
+	}
+	void SendDue()
+	{
+		const Clock::time_point now = Clock::now();
+		while(!m_delayed.empty() && m_delayed.begin()->first <= now)
+		{
+			const int fd = m_delayed.begin()->second ;
+			Connection& connection = m_clients.find(fd)->second ;
+			m_delayed.erase(m_delayed.begin());
+			connection.scheduled = false ;
+			Flush(fd, connection);
+		}
+		while(!m_delayedDatagrams.empty() && m_delayedDatagrams.begin()->first <= now)
+		{
+			const Datagram& datagram = m_delayedDatagrams.begin()->second ;
+			sendto(m_datagrams, datagram.bytes.data(), datagram.bytes.size(), 0,
+				reinterpret_cast<const sockaddr*>(&datagram.to), sizeof datagram.to);
+			m_delayedDatagrams.erase(m_delayedDatagrams.begin());
+		}
+	}
+};
+
+}
+
+#endif
@@ -0,0 +1,211 @@
+#ifndef TINYMOCKSCRIPT_H
+#define TINYMOCKSCRIPT_H
+
+/*
+Expectation scripts read in place.
+
+A script is a trace, see TinyMockTrace.h, whose records stand for the
+expected calls of one mock, in order. MappedScript maps the file into memory
+and makes each expectation only when a call of its method finds none: the
+records in between are made into expectations of their own methods on the
+way. Opening a script costs the same for any length.
+
+	typedef TinyMock::Method<int,void,void,void,int> Read_t ;
+	TinyMock::MappedScript script("reader.script");
+	script.On<int,int>(ReadId, Read_t("Read",0,0), [](int block, int result) { return new Read_t("Read",block,result); });
+	reader->AddExpectationSource(&script);
+
+Calls of methods that no On() declares, e.g. ignored ones, do not read the
+script. A call reads ahead only while the mock holds fewer than Window()
+expectations; when its record is further ahead than that, the call is not
+expected. So what is held in memory is bounded by the window, which has to
+cover the distance between the least and the most advanced method.
+
+All the records of the script count as outstanding expectations from the
+start. The script has to stay alive as long as the mock is used.
+*/
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <functional>
+#include <set>
+#include <string>
+#include <ostream>
+#include <vector>
+
+#include "TinyMock.h"
+#include "TinyMockTrace.h"
+
+namespace TinyMock {
+
+class MappedScript : public ExpectationSource
+{
+public:
+	explicit MappedScript(const std::string& path)
+		: m_path(path), m_data(NULL), m_size(0), m_position(0), m_released(0), m_records(0), m_read(0), m_window(1 << 16)
+	{
+		const int file = open(path.c_str(), O_RDONLY);
+		if(file < 0)
+		{
+			throw TraceError("cannot open script " + path);
+		}
+		struct stat status ;
+		if(fstat(file, &status) == 0 && status.st_size >= static_cast<off_t>(TraceHeaderSize))
+		{
+			m_size = status.st_size ;
+			void* data = mmap(NULL, m_size, PROT_READ, MAP_PRIVATE, file, 0);
+			m_data = data == MAP_FAILED ? NULL : static_cast<const char*>(data);
+		}
+		close(file);
+		if(!m_data || memcmp(m_data, TraceMagic, sizeof(TraceMagic)) != 0)
+		{
+			Unmap();
+			throw TraceError(path + " is not a script");
+		}
+		madvise(const_cast<char*>(m_data), m_size, MADV_SEQUENTIAL);
+		uint16_t version = 0 ;
+		m_position = sizeof(TraceMagic);
+		ReadBytes(&version, sizeof(version));
+		if(version != TraceVersion)
+		{
+			Unmap();
+			throw TraceError(path + " is a script of an unknown version");
+		}
+		ReadBytes(&m_records, sizeof(m_records));
+	}
+	~MappedScript()
+	{
+		Unmap();
+	}
+
+	// 'make' gets the values recorded with 'method' and returns the
+	// expectation they stand for, of the method of 'prototype'.
+	template <typename... V, typename M>
+	void On(uint16_t method, const M& prototype, const typename Identity<std::function<BaseMethod*(V...)> >::type& make)
+	{
+		if(method >= m_decoders.size())
+		{
+			m_decoders.resize(method + 1);
+			m_signatures.resize(method + 1);
+		}
+		M signature(prototype);
+		m_signatures[method] = signature.Signature();
+		m_scripted.insert(m_signatures[method]);
+		MappedScript* script = this ;
+		m_decoders[method] = [script, make]()
+		{
+			TraceValues<V...> decoded(*script);
+			return ApplyTraceValues(make, decoded.values, std::index_sequence_for<V...>());
+		};
+	}
+
+	// The most expectations the mock holds before a call stops reading ahead.
+	void Window(size_t expectations)
+	{
+		m_window = expectations ;
+	}
+	size_t Window() const
+	{
+		return m_window ;
+	}
+
+	bool Supply(const std::string& signature, Expectations& expectations)
+	{
+		if(m_scripted.find(signature) == m_scripted.end())
+		{
+			return false ;
+		}
+		// expectations made, or registered, and not yet consumed
+		size_t held = expectations.Outstanding() - Pending();
+		for(; m_read < m_records && held < m_window; ++held)
+		{
+			uint16_t method = 0 ;
+			ReadBytes(&method, sizeof(method));
+			if(method >= m_decoders.size() || !m_decoders[method])
+			{
+				throw TraceError("no handler for a method in script " + m_path);
+			}
+			BaseMethod* expectation = m_decoders[method]();
+			++m_read ;
+			expectations.Materialise(m_signatures[method], expectation);
+			ReleaseConsumedPages();
+			if(m_signatures[method] == signature)
+			{
+				return true ;
+			}
+		}
+		return false ;
+	}
+
+	size_t Pending() const
+	{
+		return m_records - m_read ;
+	}
+	std::string Signature() const
+	{
+		return "script " + m_path ;
+	}
+	void PrintPending(std::ostream& os, const std::string& className) const
+	{
+		if(Pending())
+		{
+			os << className << "::" << Pending() << " calls not yet read from " << m_path << std::endl ;
+		}
+	}
+	void Clear()
+	{
+		m_read = m_records ;
+		m_position = m_size ;
+	}
+
+	void ReadBytes(void* data, size_t size)
+	{
+		if(m_size - m_position < size)
+		{
+			throw TraceError("script " + m_path + " ends in the middle of a record");
+		}
+		memcpy(data, m_data + m_position, size);
+		m_position += size ;
+	}
+
+private:
+	std::string m_path ;
+	const char* m_data ;
+	size_t m_size ;
+	size_t m_position ;
+	size_t m_released ;
+	uint64_t m_records ;
+	uint64_t m_read ;
+	size_t m_window ;
+	std::vector<std::function<BaseMethod*()> > m_decoders ;
+	std::vector<std::string> m_signatures ;
+	std::set<std::string> m_scripted ;
+
+	// Gives the pages read so far back, a megabyte at a time.
+	void ReleaseConsumedPages()
+	{
+		const size_t chunk = 1 << 20 ;
+		if(m_position - m_released >= 2 * chunk)
+		{
+			const size_t release = (m_position - m_released) / chunk * chunk - chunk ;
+			madvise(const_cast<char*>(m_data) + m_released, release, MADV_DONTNEED);
+			m_released += release ;
+		}
+	}
+	void Unmap()
+	{
+		if(m_data)
+		{
+			munmap(const_cast<char*>(m_data), m_size);
+			m_data = NULL ;
+		}
+	}
+};
+
+}
+
+#endif
@@ -0,0 +1,550 @@
+#ifndef TINYMOCKSHARED_H
+#define TINYMOCKSHARED_H
+
+/*
+Mocks shared with forked processes.
+
+The expectations and the violations of a SharedMockRepository live in a
+shared memory segment that forked processes inherit. Workers forked by the
+code under test call the mocks the test set up, and the test verifies all
+of their calls once it has waited for them:
+
+	TinyMock::SharedMockRepository<ConcreteNotifier> repository ;
+	WriterMock* writer = repository.CreateMock<WriterMock,ConcreteNotifier>("Writer");
+	TinyMock::SharedQueue<Method<int,void,void,void,void> >& writes =
+		repository.Share(writer, Method<int,void,void,void,void>("Write",0));
+	writes.Expect(Method<int,void,void,void,void>("Write",1));
+	... fork workers that call writer->Write(1), wait for them ...
+	repository.verifyAll();
+
+A shared method is a bounded queue in the segment. Any process registers
+and takes expectations with atomic operations, without locks, so a worker
+that is killed leaves the queue consistent. The values of an expectation
+are copied into the queue, so its argument and result types have to be
+trivially copyable; its name is the prototype's. Violations go, truncated
+to a fixed length, to a log in the segment, and verifyAll() reports those
+of all the processes.
+
+Queues are made before forking. Everything else about a mock stays per
+process: ignored methods, stubs, sequences, and the expectations
+registered with RegisterExpectation().
+*/
+
+#include <string.h>
+#include <sys/mman.h>
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <new>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "TinyMock.h"
+
+namespace TinyMock {
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2 && ATOMIC_INT_LOCK_FREE == 2, "shared queues need lock-free atomics");
+
+class SharedMemoryError : public std::exception
+{
+public:
+	SharedMemoryError(const std::string& message) : m_message(message) {}
+	virtual ~SharedMemoryError() throw() {}
+	virtual const char* what() const throw()
+	{
+		return m_message.c_str();
+	}
+private:
+	std::string m_message ;
+};
+
+// An anonymous shared mapping, inherited by forked processes. Room is handed
+// out from the front, a cache line at a time, and lives as long as the
+// segment.
+class SharedSegment
+{
+public:
+	enum { Alignment = 64 };
+
+	explicit SharedSegment(size_t bytes) : m_size(Alignment + Rounded(bytes))
+	{
+		void* base = mmap(NULL, m_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+		if(base == MAP_FAILED)
+		{
+			throw SharedMemoryError("cannot map a shared segment");
+		}
+		m_base = static_cast<char*>(base);
+		new (m_base) std::atomic<size_t>(0);
+	}
+	~SharedSegment()
+	{
+		munmap(m_base, m_size);
+	}
+	void* Allocate(size_t bytes)
+	{
+		const size_t rounded = Rounded(bytes);
+		const size_t offset = Used().fetch_add(rounded);
+		if(offset + rounded > m_size - Alignment)
+		{
+			throw SharedMemoryError("shared segment full");
+		}
+		return m_base + Alignment + offset ;
+	}
+private:
+	SharedSegment(const SharedSegment&);
+	SharedSegment& operator=(const SharedSegment&);
+
+	char* m_base ;
+	size_t m_size ;
+
+	static size_t Rounded(size_t bytes)
+	{
+		return (bytes + Alignment - 1) / Alignment * Alignment ;
+	}
+	std::atomic<size_t>& Used()
+	{
+		return *reinterpret_cast<std::atomic<size_t>*>(m_base);
+	}
+};
+
+// The values of a Method as a shared queue keeps them.
+struct NoValue {};
+
+template <typename T>
+struct SharedValue
+{
+	typedef T type ;
+};
+
+template <>
+struct SharedValue<void>
+{
+	typedef NoValue type ;
+};
+
+template <typename M>
+struct SharedRecord ;
+
+template <typename P1, typename P2, typename P3, typename P4, typename R>
+struct SharedRecord<Method<P1,P2,P3,P4,R> >
+{
+	typedef Method<P1,P2,P3,P4,R> Method_t ;
+
+	typename SharedValue<P1>::type p1 ;
+	typename SharedValue<P2>::type p2 ;
+	typename SharedValue<P3>::type p3 ;
+	typename SharedValue<P4>::type p4 ;
+	typename SharedValue<R>::type r ;
+
+	void Load(const Method_t& method)
+	{
+		LoadArgument(p1, method, 0);
+		LoadArgument(p2, method, 1);
+		LoadArgument(p3, method, 2);
+		LoadArgument(p4, method, 3);
+		LoadResult(r, method);
+	}
+	void Store(Method_t& method) const
+	{
+		StoreArgument(p1, method, 0);
+		StoreArgument(p2, method, 1);
+		StoreArgument(p3, method, 2);
+		StoreArgument(p4, method, 3);
+		StoreResult(r, method);
+	}
+private:
+	template <typename T>
+	static void LoadArgument(T& value, const Method_t& method, size_t index)
+	{
+		value = *static_cast<const T*>(Method_t::Argument(method, index));
+	}
+	static void LoadArgument(NoValue&, const Method_t&, size_t) {}
+	template <typename T>
+	static void StoreArgument(const T& value, Method_t& method, size_t index)
+	{
+		*static_cast<T*>(const_cast<void*>(Method_t::Argument(method, index))) = value ;
+	}
+	static void StoreArgument(const NoValue&, Method_t&, size_t) {}
+	template <typename T>
+	static void LoadResult(T& value, const Method_t& method)
+	{
+		value = method.m_r ;
+	}
+	static void LoadResult(NoValue&, const Method_t&) {}
+	template <typename T>
+	static void StoreResult(const T& value, Method_t& method)
+	{
+		method.m_r = value ;
+	}
+	static void StoreResult(const NoValue&, Method_t&) {}
+};
+
+// A source of expectations whose counts change in other processes too.
+class SharedSource : public ExpectationSource
+{
+public:
+	// Brings the counts of the mock in this process up to what all the
+	// processes registered and took.
+	virtual void Reconcile() = 0;
+	// Empties the queue; no other process may use it meanwhile.
+	virtual void Rewind() = 0;
+};
+
+// The expected calls of one method of a mock, in a shared segment: slots
+// are reserved by the processes registering and taken in order by the
+// processes calling, each with one atomic operation.
+template <typename M>
+class SharedQueue : public SharedSource, public MethodRecycler
+{
+	typedef SharedRecord<M> Record ;
+	static_assert(std::is_trivially_copyable<Record>::value, "shared expectations need trivially copyable values");
+
+	struct Slot
+	{
+		Slot() : ready(0), record() {}
+		std::atomic<unsigned> ready ;
+		Record record ;
+	};
+	struct State
+	{
+		State() : reserved(0), taken(0) {}
+		std::atomic<unsigned long long> reserved ;
+		std::atomic<unsigned long long> taken ;
+	};
+public:
+	SharedQueue(SharedSegment& segment, Mock& mock, const M& prototype, size_t capacity)
+		: m_mock(mock), m_prototype(prototype), m_signature(m_prototype.Signature()), m_capacity(capacity),
+		  m_registered(0), m_taken(0)
+	{
+		m_state = new (segment.Allocate(sizeof(State))) State();
+		m_slots = static_cast<Slot*>(segment.Allocate(capacity * sizeof(Slot)));
+		for(size_t s = 0; s < capacity; ++s)
+		{
+			new (&m_slots[s]) Slot();
+		}
+		m_mock.AddExpectationSource(this);
+	}
+	~SharedQueue()
+	{
+		for(size_t i = 0; i < m_pool.size(); ++i)
+		{
+			delete m_pool[i];
+		}
+	}
+
+	// Expects a call with the values of 'expected'.
+	void Expect(const M& expected)
+	{
+		const unsigned long long slot = m_state->reserved.fetch_add(1);
+		if(slot >= m_capacity)
+		{
+			m_state->reserved.fetch_sub(1);
+			throw SharedMemoryError("shared queue of " + m_signature + " full");
+		}
+		m_slots[slot].record.Load(expected);
+		m_slots[slot].ready.store(1, std::memory_order_release);
+		++m_registered ;
+		m_mock.SourceRegistered(1);
+	}
+
+	bool Supply(const std::string& signature, Expectations& expectations)
+	{
+		unsigned long long slot = 0 ;
+		if(signature != m_signature || !Take(slot))
+		{
+			return false ;
+		}
+		++m_taken ;
+		M* expected = NULL ;
+		if(m_free.empty())
+		{
+			expected = new M(m_prototype);
+			expected->RecycleWith(this);
+			m_pool.push_back(expected);
+		}
+		else
+		{
+			expected = m_free.back();
+			m_free.pop_back();
+		}
+		m_slots[slot].record.Store(*expected);
+		expectations.Materialise(m_signature, expected);
+		return true ;
+	}
+	void Recycle(BaseMethod* method)
+	{
+		m_free.push_back(static_cast<M*>(method));
+	}
+
+	size_t Pending() const
+	{
+		const unsigned long long registered = Registered();
+		const unsigned long long taken = m_state->taken.load();
+		return registered > taken ? size_t(registered - taken) : 0 ;
+	}
+	std::string Signature() const
+	{
+		return m_signature ;
+	}
+	void PrintPending(std::ostream& os, const std::string& className) const
+	{
+		const unsigned long long registered = Registered();
+		for(unsigned long long slot = m_state->taken.load(); slot < registered; ++slot)
+		{
+			if(m_slots[slot].ready.load(std::memory_order_acquire))
+			{
+				M pending(m_prototype);
+				m_slots[slot].record.Store(pending);
+				os << className << "::" << pending.ToString() << std::endl ;
+			}
+		}
+	}
+	void Clear()
+	{
+		const unsigned long long registered = Registered();
+		unsigned long long taken = m_state->taken.load();
+		while(taken < registered)
+		{
+			if(m_state->taken.compare_exchange_weak(taken, registered))
+			{
+				m_taken += registered - taken ;
+				return ;
+			}
+		}
+	}
+	void Reconcile()
+	{
+		const unsigned long long registered = Registered();
+		const unsigned long long taken = m_state->taken.load();
+		if(registered > m_registered)
+		{
+			m_mock.SourceRegistered(size_t(registered - m_registered));
+			m_registered = registered ;
+		}
+		if(taken > m_taken)
+		{
+			m_mock.SourceConsumed(size_t(taken - m_taken));
+			m_taken = taken ;
+		}
+	}
+	void Rewind()
+	{
+		for(size_t s = 0; s < m_capacity; ++s)
+		{
+			m_slots[s].ready.store(0);
+		}
+		m_state->taken.store(0);
+		m_state->reserved.store(0);
+		m_registered = 0 ;
+		m_taken = 0 ;
+	}
+private:
+	Mock& m_mock ;
+	M m_prototype ;
+	std::string m_signature ;
+	State* m_state ;
+	Slot* m_slots ;
+	unsigned long long m_capacity ;
+	// what this process has counted in m_mock
+	unsigned long long m_registered ;
+	unsigned long long m_taken ;
+	std::vector<M*> m_pool ;
+	std::vector<M*> m_free ;
+
+	unsigned long long Registered() const
+	{
+		return std::min(m_state->reserved.load(), m_capacity);
+	}
+	// A slot still being written counts as not registered yet.
+	bool Take(unsigned long long& slot)
+	{
+		slot = m_state->taken.load(std::memory_order_acquire);
+		while(slot < m_capacity && m_slots[slot].ready.load(std::memory_order_acquire))
+		{
+			if(m_state->taken.compare_exchange_weak(slot, slot + 1, std::memory_order_acq_rel))
+			{
+				return true ;
+			}
+		}
+		return false ;
+	}
+};
+
+// The violations of all the processes, in a shared segment.
+class SharedViolations : public ViolationSink
+{
+	enum { TextSize = 256 };
+	struct Slot
+	{
+		Slot() : ready(0), kind(0) {}
+		std::atomic<unsigned> ready ;
+		int kind ;
+		char mockName[TextSize] ;
+		char expected[TextSize] ;
+		char actual[TextSize] ;
+	};
+public:
+	SharedViolations(SharedSegment& segment, size_t capacity) : m_capacity(capacity)
+	{
+		m_appended = new (segment.Allocate(sizeof(std::atomic<unsigned long long>))) std::atomic<unsigned long long>(0);
+		m_slots = static_cast<Slot*>(segment.Allocate(capacity * sizeof(Slot)));
+		for(size_t s = 0; s < capacity; ++s)
+		{
+			new (&m_slots[s]) Slot();
+		}
+	}
+	void Append(Violation::Kind kind, const std::string& mockName, const std::string& expected, const std::string& actual)
+	{
+		const unsigned long long appended = m_appended->fetch_add(1);
+		if(appended >= m_capacity)
+		{
+			return ;
+		}
+		Slot& slot = m_slots[appended];
+		slot.kind = kind ;
+		Copy(slot.mockName, mockName);
+		Copy(slot.expected, expected);
+		Copy(slot.actual, actual);
+		slot.ready.store(1, std::memory_order_release);
+	}
+	bool IsEmpty() const
+	{
+		return m_appended->load() == 0 ;
+	}
+	// 'log' has to have room for the capacity; the violations beyond it
+	// are counted as dropped there too.
+	void CopyTo(ViolationLog& log) const
+	{
+		log.Clear();
+		const unsigned long long appended = m_appended->load();
+		for(unsigned long long v = 0; v < appended; ++v)
+		{
+			if(v >= m_capacity)
+			{
+				log.Append(Violation::NotExpected, std::string(), std::string(), std::string());
+			}
+			else if(m_slots[v].ready.load(std::memory_order_acquire))
+			{
+				const Slot& slot = m_slots[v];
+				log.Append(Violation::Kind(slot.kind), slot.mockName, slot.expected, slot.actual);
+			}
+		}
+	}
+	// No other process may append meanwhile.
+	void Clear()
+	{
+		for(size_t s = 0; s < m_capacity; ++s)
+		{
+			m_slots[s].ready.store(0);
+		}
+		m_appended->store(0);
+	}
+	size_t Capacity() const
+	{
+		return m_capacity ;
+	}
+private:
+	std::atomic<unsigned long long>* m_appended ;
+	Slot* m_slots ;
+	size_t m_capacity ;
+
+	static void Copy(char* text, const std::string& value)
+	{
+		if(value.size() < TextSize)
+		{
+			memcpy(text, value.c_str(), value.size() + 1);
+			return ;
+		}
+		memcpy(text, value.c_str(), TextSize - 4);
+		memcpy(text + TextSize - 4, "...", 4);
+	}
+};
+
+// A MockRepository whose mocks report their violations to a shared log, and
+// whose shared queues, see Share(), are verified with the calls of all the
+// processes. Call verifyAll() once the other processes are done.
+template<typename P=TinyNotifier>
+class SharedMockRepository : public MockRepository<P>
+{
+public:
+	explicit SharedMockRepository(size_t bytes = 1 << 22, size_t violations = 256)
+		: m_segment(bytes), m_violations(m_segment, violations)
+	{
+		m_forwarding.ForwardTo(&m_violations);
+		m_collected.Reserve(violations);
+	}
+	~SharedMockRepository()
+	{
+		for(size_t q = 0; q < m_queues.size(); ++q)
+		{
+			delete m_queues[q];
+		}
+	}
+
+	// A queue of at most 'capacity' expected calls of the method of
+	// 'prototype' of an owned mock, shared with the processes forked from now.
+	template<typename M>
+	SharedQueue<M>& Share(Mock* mock, const M& prototype, size_t capacity = 1024)
+	{
+		SharedQueue<M>* queue = new SharedQueue<M>(m_segment, *mock, prototype, capacity);
+		m_queues.push_back(queue);
+		return *queue ;
+	}
+
+	// The violations of all the processes so far.
+	const ViolationLog& Violations() const
+	{
+		m_violations.CopyTo(m_collected);
+		return m_collected ;
+	}
+
+	// Also empties the shared queues and log; no other process may use them
+	// meanwhile.
+	void Reset()
+	{
+		MockRepository<P>::Reset();
+		for(size_t q = 0; q < m_queues.size(); ++q)
+		{
+			m_queues[q]->Rewind();
+		}
+		m_violations.Clear();
+	}
+private:
+	SharedSegment m_segment ;
+	SharedViolations m_violations ;
+	ViolationLog m_forwarding ;
+	mutable ViolationLog m_collected ;
+	std::vector<SharedSource*> m_queues ;
+
+	void Reconcile() const
+	{
+		for(size_t q = 0; q < m_queues.size(); ++q)
+		{
+			m_queues[q]->Reconcile();
+		}
+	}
+
+	ViolationLog* ViolationsOfMocks()
+	{
+		return &m_forwarding ;
+	}
+
+	bool ReportViolations()
+	{
+		if(m_violations.IsEmpty())
+		{
+			return false ;
+		}
+		m_violations.CopyTo(m_collected);
+		m_collected.Report();
+		m_collected.Clear();
+		m_violations.Clear();
+		return true ;
+	}
+};
+
+}
+
+#endif
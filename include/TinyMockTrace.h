@@ -0,0 +1,374 @@
+#ifndef TINYMOCKTRACE_H
+#define TINYMOCKTRACE_H
+
+/*
+Record and replay of calls to a mocked interface.
+
+A recording proxy implements the interface on top of the real
+implementation and writes every call to a TraceWriter: a method id chosen
+by the proxy, the arguments and the return value, as raw bytes. Nothing is
+formatted; the trace is written and read through a buffer, so traces of
+millions of calls stream through in constant memory.
+
+	int RecordingReader::Read(int block)
+	{
+		const int result = m_real.Read(block);
+		m_trace.Record(ReadId, block, result);
+		return result ;
+	}
+
+A TraceReplayer turns the records back into expectations, with one handler
+per method id that gets the recorded values in the same order:
+
+	TinyMock::TraceReader trace("reader.trace");
+	TinyMock::TraceReplayer replayer(trace);
+	replayer.On<int,int>(ReadId, [&](int block, int result) { reader->read.Expect(block).Returns(result); });
+	replayer.ReplayAll();
+
+The values are stored in the byte order of the machine that recorded them.
+Trivially copyable types are stored as they are; specialise TraceValue for
+others, as is done for std::string. Read() takes anything with
+ReadBytes(data, size), so that a trace can also be decoded in place, see
+TinyMockScript.h.
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "TinyMock.h"
+
+namespace TinyMock {
+
+class TraceError : public std::exception
+{
+public:
+	TraceError(const std::string& message) : m_message(message) {}
+	virtual ~TraceError() throw() {}
+	virtual const char* what() const throw()
+	{
+		return m_message.c_str();
+	}
+private:
+	std::string m_message ;
+};
+
+const char TraceMagic[4] = { 'T', 'M', 'T', 'R' };
+const uint16_t TraceVersion = 1 ;
+// The header is the magic, the version and the number of records.
+const long TraceRecordsOffset = sizeof(TraceMagic) + sizeof(TraceVersion);
+const size_t TraceHeaderSize = TraceRecordsOffset + sizeof(uint64_t);
+
+typedef std::unique_ptr<FILE, int(*)(FILE*)> TraceFile_t ;
+
+class TraceWriter
+{
+public:
+	explicit TraceWriter(const std::string& path, size_t bufferSize = 1 << 16)
+		: m_path(path), m_file(fopen(path.c_str(), "wb"), &fclose), m_buffer(bufferSize), m_used(0), m_records(0)
+	{
+		if(!m_file)
+		{
+			throw TraceError("cannot open trace " + path + " for writing");
+		}
+		const uint64_t records = 0 ;
+		WriteBytes(TraceMagic, sizeof(TraceMagic));
+		WriteBytes(&TraceVersion, sizeof(TraceVersion));
+		WriteBytes(&records, sizeof(records));
+	}
+	// Close() to learn whether the trace was written completely.
+	~TraceWriter()
+	{
+		try
+		{
+			Close();
+		}
+		catch(const TraceError&)
+		{
+		}
+	}
+
+	template <typename... V>
+	void Record(uint16_t method, const V&... values) ;
+
+	void WriteBytes(const void* data, size_t size)
+	{
+		if(m_used + size > m_buffer.size())
+		{
+			Flush();
+			if(size > m_buffer.size())
+			{
+				Put(data, size);
+				return ;
+			}
+		}
+		memcpy(&m_buffer[m_used], data, size);
+		m_used += size ;
+	}
+	void Flush()
+	{
+		Put(&m_buffer[0], m_used);
+		m_used = 0 ;
+	}
+	// Writes out the buffer and the number of records in the header; the
+	// file is closed even when that fails.
+	void Close()
+	{
+		if(!m_file)
+		{
+			return ;
+		}
+		try
+		{
+			Flush();
+			const uint64_t records = m_records ;
+			if(fseek(m_file.get(), TraceRecordsOffset, SEEK_SET) != 0 || fwrite(&records, sizeof(records), 1, m_file.get()) != 1)
+			{
+				throw TraceError("cannot write the number of records of trace " + m_path);
+			}
+		}
+		catch(...)
+		{
+			m_file.reset();
+			throw ;
+		}
+		if(fclose(m_file.release()) != 0)
+		{
+			throw TraceError("cannot close trace " + m_path);
+		}
+	}
+	size_t Records() const
+	{
+		return m_records ;
+	}
+private:
+	std::string m_path ;
+	TraceFile_t m_file ;
+	std::vector<char> m_buffer ;
+	size_t m_used ;
+	size_t m_records ;
+
+	void Put(const void* data, size_t size)
+	{
+		if(size && fwrite(data, 1, size, m_file.get()) != size)
+		{
+			throw TraceError("cannot write trace " + m_path);
+		}
+	}
+};
+
+class TraceReader
+{
+public:
+	explicit TraceReader(const std::string& path, size_t bufferSize = 1 << 16)
+		: m_file(fopen(path.c_str(), "rb"), &fclose), m_buffer(bufferSize), m_position(0), m_end(0), m_records(0)
+	{
+		if(!m_file)
+		{
+			throw TraceError("cannot open trace " + path + " for reading");
+		}
+		char header[TraceHeaderSize];
+		uint16_t version = 0 ;
+		if(Read(header, sizeof(header)) != sizeof(header) || memcmp(header, TraceMagic, sizeof(TraceMagic)) != 0)
+		{
+			throw TraceError(path + " is not a trace");
+		}
+		memcpy(&version, header + sizeof(TraceMagic), sizeof(version));
+		if(version != TraceVersion)
+		{
+			throw TraceError(path + " is a trace of an unknown version");
+		}
+		memcpy(&m_records, header + TraceRecordsOffset, sizeof(m_records));
+	}
+
+	uint64_t Records() const
+	{
+		return m_records ;
+	}
+	// False at the end of the trace; a record cut short is an error.
+	bool ReadMethod(uint16_t& method)
+	{
+		return TryReadBytes(&method, sizeof(method));
+	}
+	void ReadBytes(void* data, size_t size)
+	{
+		if(!TryReadBytes(data, size))
+		{
+			throw TraceError("trace ends in the middle of a record");
+		}
+	}
+private:
+	TraceFile_t m_file ;
+	std::vector<char> m_buffer ;
+	size_t m_position ;
+	size_t m_end ;
+	uint64_t m_records ;
+
+	// False when the trace ends before the first byte.
+	bool TryReadBytes(void* data, size_t size)
+	{
+		const size_t copied = Read(data, size);
+		if(copied && copied < size)
+		{
+			throw TraceError("trace ends in the middle of a record");
+		}
+		return copied == size ;
+	}
+	// Up to 'size' bytes, fewer at the end of the trace.
+	size_t Read(void* data, size_t size)
+	{
+		char* destination = static_cast<char*>(data);
+		size_t copied = 0 ;
+		while(copied < size && (m_position < m_end || Refill()))
+		{
+			const size_t chunk = std::min(size - copied, m_end - m_position);
+			memcpy(destination + copied, &m_buffer[m_position], chunk);
+			m_position += chunk ;
+			copied += chunk ;
+		}
+		return copied ;
+	}
+	bool Refill()
+	{
+		m_position = 0 ;
+		m_end = fread(&m_buffer[0], 1, m_buffer.size(), m_file.get());
+		return m_end != 0 ;
+	}
+};
+
+template <typename T>
+struct TraceValue
+{
+	static_assert(std::is_trivially_copyable<T>::value, "specialise TraceValue for this type");
+	static void Write(TraceWriter& writer, const T& value)
+	{
+		writer.WriteBytes(&value, sizeof(T));
+	}
+	template <typename Reader>
+	static T Read(Reader& reader)
+	{
+		T value ;
+		reader.ReadBytes(&value, sizeof(T));
+		return value ;
+	}
+};
+
+template <>
+struct TraceValue<std::string>
+{
+	static void Write(TraceWriter& writer, const std::string& value)
+	{
+		const uint32_t size = static_cast<uint32_t>(value.size());
+		writer.WriteBytes(&size, sizeof(size));
+		writer.WriteBytes(value.data(), size);
+	}
+	template <typename Reader>
+	static std::string Read(Reader& reader)
+	{
+		uint32_t size = 0 ;
+		reader.ReadBytes(&size, sizeof(size));
+		std::string value(size, '\0');
+		if(size)
+		{
+			reader.ReadBytes(&value[0], size);
+		}
+		return value ;
+	}
+};
+
+template <typename... V>
+void TraceWriter::Record(uint16_t method, const V&... values)
+{
+	WriteBytes(&method, sizeof(method));
+	int expand[] = { 0, (TraceValue<V>::Write(*this, values), 0)... };
+	(void)expand ;
+	++m_records ;
+}
+
+// The values of one record. Braced initialisation reads them left to right.
+template <typename... V>
+struct TraceValues
+{
+	template <typename Reader>
+	TraceValues(Reader& reader) : values{ TraceValue<V>::template Read<Reader>(reader)... } {}
+	std::tuple<V...> values ;
+};
+
+template <typename F, typename... V, size_t... I>
+auto ApplyTraceValues(const F& handler, std::tuple<V...>& values, std::index_sequence<I...>) -> decltype(handler(std::get<I>(values)...))
+{
+	return handler(std::get<I>(values)...);
+}
+
+template <typename T>
+struct Identity
+{
+	typedef T type ;
+};
+
+class TraceReplayer
+{
+public:
+	explicit TraceReplayer(TraceReader& reader) : m_reader(reader) {}
+
+	// 'handler' gets the values recorded with 'method', in the order they
+	// were recorded, and registers the expectations they stand for.
+	template <typename... V>
+	void On(uint16_t method, const typename Identity<std::function<void(V...)> >::type& handler)
+	{
+		if(method >= m_decoders.size())
+		{
+			m_decoders.resize(method + 1);
+		}
+		TraceReader& reader = m_reader ;
+		m_decoders[method] = [&reader, handler]() { Decode<V...>(reader, handler); };
+	}
+
+	// Replays the next record; false at the end of the trace.
+	bool ReplayNext()
+	{
+		uint16_t method = 0 ;
+		if(!m_reader.ReadMethod(method))
+		{
+			return false ;
+		}
+		if(method >= m_decoders.size() || !m_decoders[method])
+		{
+			throw TraceError("no handler for a method in the trace");
+		}
+		m_decoders[method]();
+		return true ;
+	}
+	// Returns how many records were replayed.
+	size_t ReplayAll()
+	{
+		size_t replayed = 0 ;
+		while(ReplayNext())
+		{
+			++replayed ;
+		}
+		return replayed ;
+	}
+private:
+	TraceReader& m_reader ;
+	std::vector<std::function<void()> > m_decoders ;
+
+	template <typename... V>
+	static void Decode(TraceReader& reader, const std::function<void(V...)>& handler)
+	{
+		TraceValues<V...> decoded(reader);
+		ApplyTraceValues(handler, decoded.values, std::index_sequence_for<V...>());
+	}
+};
+
+}
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef TINYMOCKYAFFUT_H
+#define TINYMOCKYAFFUT_H
+
+// Glue between TinyMock and yaffut, pulled in automatically by whichever of
+// the two headers is included last.
+
+#include "yaffut.h"
+#include "TinyMock.h"
+
+namespace TinyMock {
+namespace {
+
+struct YaffutHangReporter
+{
+	YaffutHangReporter()
+	{
+		yaffut::Factory::Instance().AddHangReporter(&LiveRepositories::PrintPendingExpectations);
+	}
+};
+
+YaffutHangReporter yaffutHangReporter ;
+
+}
+}
+
+#endif
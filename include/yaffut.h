@@ -15,12 +15,42 @@
 #pragma warning (disable: 4786)
 #endif
 
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#endif
+
+#ifdef __unix__
+#include <poll.h>
+#include <signal.h>
+#include <sys/wait.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
 #include <cmath>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
 #include <limits>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <set>
 #include <sstream>
 #include <stdexcept>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace yaffut {
 
@@ -59,22 +89,455 @@ std::string demangle()
   return name;
 }
 
+class timeout: public std::exception
+{
+  std::string timeout_;
+public:
+  explicit timeout(unsigned milliseconds)
+  {
+    std::ostringstream os;
+    os << "test did not finish within " << milliseconds << " ms";
+    timeout_ = os.str();
+  }
+  virtual ~timeout() throw() {}
+  virtual const char* what() const throw() { return timeout_.c_str(); }
+};
+
+// Allocation counting. With YAFFUT_TRACK_ALLOCATIONS defined in the file
+// that defines main(), the global operator new and delete are replaced by
+// ones that count the allocations and bytes of each thread: every passing
+// test reports its counts, and ASSERT_NO_ALLOC { ... } and
+// ASSERT_MAX_ALLOCS(n) { ... } check a block on the thread running it.
+// Over-aligned allocations are not counted.
+struct AllocationCount
+{
+  unsigned long long allocations;
+  unsigned long long bytes;
+};
+
+inline AllocationCount& ThreadAllocations()
+{
+  // zero-initialised, without a constructor, so safe in operator new
+  static thread_local AllocationCount count;
+  return count;
+}
+
+inline bool& AllocationsCounted()
+{
+  static bool counted = false;
+  return counted;
+}
+
+inline void CountAllocation(std::size_t bytes)
+{
+  AllocationCount& count = ThreadAllocations();
+  ++count.allocations;
+  count.bytes += bytes;
+}
+
+// the allocations of the current thread since construction
+class AllocationMeter
+{
+  AllocationCount m_start;
+public:
+  AllocationMeter(): m_start(ThreadAllocations()) {}
+  AllocationCount Counted() const
+  {
+    const AllocationCount& now = ThreadAllocations();
+    AllocationCount counted = { now.allocations - m_start.allocations, now.bytes - m_start.bytes };
+    return counted;
+  }
+};
+
+// Performance counters of a thread, see CounterMeter.
+struct Counters
+{
+  enum Counter { Cycles, Instructions, CacheReferences, CacheMisses, Branches, BranchMisses,
+                 TaskClock, ContextSwitches, PageFaults, Size };
+  Counters()
+  {
+    for(int c = 0; c < Size; ++c)
+    {
+      value[c] = 0;
+      available[c] = false;
+    }
+  }
+  bool Has(Counter counter) const
+  {
+    return available[counter];
+  }
+  double value[Size];
+  bool available[Size];
+};
+
+// IPC and miss rates from the hardware counters, or else what the software
+// counters counted
+inline std::ostream& operator<<(std::ostream& os, const Counters& counters)
+{
+  std::ostringstream out;
+  out << std::fixed << std::setprecision(2);
+  const char* separator = "";
+  if(counters.Has(Counters::Cycles) && counters.Has(Counters::Instructions) && counters.value[Counters::Cycles] > 0)
+  {
+    out << "IPC " << counters.value[Counters::Instructions] / counters.value[Counters::Cycles];
+    separator = ", ";
+  }
+  if(counters.Has(Counters::CacheReferences) && counters.Has(Counters::CacheMisses) && counters.value[Counters::CacheReferences] > 0)
+  {
+    out << separator << "cache misses " << 100 * counters.value[Counters::CacheMisses] / counters.value[Counters::CacheReferences] << '%';
+    separator = ", ";
+  }
+  if(counters.Has(Counters::Branches) && counters.Has(Counters::BranchMisses) && counters.value[Counters::Branches] > 0)
+  {
+    out << separator << "branch misses " << 100 * counters.value[Counters::BranchMisses] / counters.value[Counters::Branches] << '%';
+    separator = ", ";
+  }
+  if(*separator == 0)
+  {
+    out << std::setprecision(0);
+    if(counters.Has(Counters::TaskClock))
+    {
+      out << "task clock " << counters.value[Counters::TaskClock] / 1000 << " us";
+      separator = ", ";
+    }
+    if(counters.Has(Counters::ContextSwitches))
+    {
+      out << separator << counters.value[Counters::ContextSwitches] << " context switches";
+      separator = ", ";
+    }
+    if(counters.Has(Counters::PageFaults))
+    {
+      out << separator << counters.value[Counters::PageFaults] << " page faults";
+      separator = ", ";
+    }
+  }
+  if(*separator == 0)
+  {
+    out << "counters unavailable";
+  }
+  return os << out.str();
+}
+
+// Counts the current thread's events with perf_event_open from construction.
+// The kernel often does not allow the hardware counters, in containers and
+// virtual machines; the software ones then still count, and a counter that
+// cannot be opened is unavailable.
+class CounterMeter
+{
+  int m_fd[Counters::Size];
+  CounterMeter(const CounterMeter&);
+  CounterMeter& operator=(const CounterMeter&);
+public:
+  explicit CounterMeter(bool count = true)
+  {
+    for(int c = 0; c < Counters::Size; ++c)
+    {
+      m_fd[c] = count ? Open(Counters::Counter(c)) : -1;
+    }
+  }
+  ~CounterMeter()
+  {
+#ifdef __linux__
+    for(int c = 0; c < Counters::Size; ++c)
+    {
+      if(m_fd[c] >= 0)
+      {
+        close(m_fd[c]);
+      }
+    }
+#endif
+  }
+  Counters Counted() const
+  {
+    Counters counters;
+#ifdef __linux__
+    for(int c = 0; c < Counters::Size; ++c)
+    {
+      // value, time enabled, time running; scaled up when the kernel
+      // multiplexed more counters than the hardware has
+      unsigned long long read[3];
+      if(m_fd[c] >= 0 && ::read(m_fd[c], read, sizeof read) == ssize_t(sizeof read) && read[2] > 0)
+      {
+        counters.value[c] = double(read[0]) * read[1] / read[2];
+        counters.available[c] = true;
+      }
+    }
+#endif
+    return counters;
+  }
+private:
+  static int Open(Counters::Counter counter)
+  {
+#ifdef __linux__
+    static const struct { unsigned type; unsigned long long config; } events[Counters::Size] = {
+      { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+      { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+      { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES },
+      { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+      { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_INSTRUCTIONS },
+      { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+      { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK },
+      { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES },
+      { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS },
+    };
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof attr);
+    attr.size = sizeof attr;
+    attr.type = events[counter].type;
+    attr.config = events[counter].config;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return int(syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC));
+#else
+    (void)counter;
+    return -1;
+#endif
+  }
+};
+
+inline std::string Duration(double nanoseconds)
+{
+  static const char* const units[] = { "ns", "us", "ms", "s" };
+  size_t unit = 0;
+  while(nanoseconds >= 1000 && unit < 3)
+  {
+    nanoseconds /= 1000;
+    ++unit;
+  }
+  std::ostringstream os;
+  os << std::fixed << std::setprecision(1) << nanoseconds << ' ' << units[unit];
+  return os.str();
+}
+
+// Expected times of tests and benches, a line per test:
+//   Suite::Case nanoseconds [tolerance%]
+// A bench's time is its median per operation, a test's its wall time. A
+// test measured slower than expected by more than the tolerance regressed.
+class Baseline
+{
+public:
+  typedef std::map<std::string, double> Measured_t;
+  struct Entry
+  {
+    double nanoseconds;
+    double tolerance;
+  };
+  Baseline(double tolerance = 10): m_tolerance(tolerance) {}
+  // false, with the offending line in 'error', unless 'is' is a baseline
+  bool Read(std::istream& is, std::string& error)
+  {
+    std::string line;
+    for(size_t number = 1; std::getline(is, line); ++number)
+    {
+      std::istringstream fields(line.substr(0, line.find('#')));
+      std::string name;
+      if(!(fields >> name))
+      {
+        continue;
+      }
+      Entry entry = { 0, m_tolerance };
+      std::string tolerance;
+      if(!(fields >> entry.nanoseconds) || entry.nanoseconds <= 0
+         || ((fields >> tolerance) && !ParsePercent(tolerance, entry.tolerance)))
+      {
+        std::ostringstream os;
+        os << "line " << number << ": " << line;
+        error = os.str();
+        return false;
+      }
+      m_Entries[name] = entry;
+    }
+    return true;
+  }
+  // writes the measured times, keeping the tolerances of known tests
+  void Write(std::ostream& os, const Measured_t& measured) const
+  {
+    os << "# test nanoseconds tolerance\n";
+    for(Measured_t::const_iterator m = measured.begin(); m != measured.end(); ++m)
+    {
+      std::map<std::string, Entry>::const_iterator known = m_Entries.find(m->first);
+      os << m->first << ' ' << m->second << ' '
+         << (known != m_Entries.end() ? known->second.tolerance : m_tolerance) << "%\n";
+    }
+  }
+  // prints the expected and measured times of the tests in the baseline,
+  // returns the number of regressions
+  size_t Compare(const Measured_t& measured, std::ostream& os) const
+  {
+    size_t width = 4;
+    for(std::map<std::string, Entry>::const_iterator e = m_Entries.begin(); e != m_Entries.end(); ++e)
+    {
+      width = std::max(width, e->first.size());
+    }
+    os << std::left << std::setw(int(width)) << "test" << std::right
+       << std::setw(12) << "baseline" << std::setw(12) << "measured"
+       << std::setw(10) << "change" << std::setw(11) << "tolerance" << std::endl;
+    size_t regressions = 0;
+    for(std::map<std::string, Entry>::const_iterator e = m_Entries.begin(); e != m_Entries.end(); ++e)
+    {
+      os << std::left << std::setw(int(width)) << e->first << std::right
+         << std::setw(12) << Duration(e->second.nanoseconds);
+      Measured_t::const_iterator m = measured.find(e->first);
+      if(m == measured.end())
+      {
+        os << std::setw(12) << "-" << "  not run" << std::endl;
+        continue;
+      }
+      const double change = (m->second / e->second.nanoseconds - 1) * 100;
+      std::ostringstream percent;
+      percent << std::showpos << std::fixed << std::setprecision(1) << change << '%';
+      std::ostringstream tolerance;
+      tolerance << e->second.tolerance << '%';
+      os << std::setw(12) << Duration(m->second) << std::setw(10) << percent.str()
+         << std::setw(11) << tolerance.str();
+      if(change > e->second.tolerance)
+      {
+        os << "  REGRESSED";
+        ++regressions;
+      }
+      os << std::endl;
+    }
+    return regressions;
+  }
+  size_t Size() const
+  {
+    return m_Entries.size();
+  }
+private:
+  static bool ParsePercent(const std::string& text, double& percent)
+  {
+    char* end = 0;
+    percent = std::strtod(text.c_str(), &end);
+    return end != text.c_str() && percent >= 0 && (std::string(end) == "%" || *end == 0);
+  }
+  std::map<std::string, Entry> m_Entries;
+  double m_tolerance;
+};
+
+// Lifetime of a suite-scoped fixture, see SuiteFixture.
+struct SharedFixture_t
+{
+  void (*setUp) ();
+  void (*tearDown) ();
+  bool abandoned;
+};
+
+// Sets up the shared fixtures of a run's tests and tears each down after the
+// last planned test using it, unless an abandoned test may still use it.
+class SharedFixtureLifetimes
+{
+  std::map<SharedFixture_t*, size_t> m_remaining;
+public:
+  void Plan(SharedFixture_t* fixture)
+  {
+    if(fixture)
+      ++m_remaining[fixture];
+  }
+  void Begin(SharedFixture_t* fixture)
+  {
+    if(fixture)
+      fixture->setUp();
+  }
+  void Abandon(SharedFixture_t* fixture)
+  {
+    if(fixture)
+      fixture->abandoned = true;
+  }
+  void End(SharedFixture_t* fixture)
+  {
+    if(fixture && 0 == --m_remaining[fixture] && !fixture->abandoned)
+      fixture->tearDown();
+  }
+};
+
 class Factory
 {
 public:
+  // exit code of a run whose tests passed but were too slow; a run with
+  // failures exits with their number, up to one less than this
+  static const int PerformanceFailure = 250;
   typedef void (*Create_t) ();
+  typedef void (*HangReporter_t) (std::ostream&);
 private:
   typedef std::map<std::string, Create_t> Tests_t;
+  typedef std::map<std::string, unsigned> Timeouts_t;
+  typedef std::map<std::string, SharedFixture_t*> SharedFixtures_t;
+  typedef std::vector<HangReporter_t> HangReporters_t;
+  typedef std::set<std::string> Benches_t;
+  typedef std::map<std::string, unsigned> Budgets_t;
+  struct Planned
+  {
+    Planned(size_t index, Tests_t::const_iterator test): index(index), test(test) {}
+    size_t index;
+    Tests_t::const_iterator test;
+  };
+  typedef std::vector<Planned> Plan_t;
   Tests_t m_Tests;
+  Timeouts_t m_Timeouts;
+  SharedFixtures_t m_SharedFixtures;
+  HangReporters_t m_HangReporters;
+  Benches_t m_Benches;
+  Budgets_t m_Budgets;
+  Baseline m_baseline;
+  Baseline::Measured_t m_Measured;
+  bool m_bench;
+  bool m_counters;
+  size_t m_benchSamples;
+  unsigned m_benchSampleTime;
+  unsigned m_timeout;
+  unsigned long long m_seed;
+  size_t m_iterations;
+  size_t m_shard;
+  size_t m_shards;
   size_t m_fail;
   size_t m_pass;
+  size_t m_slow;
 private:
-  Factory(){}
+  Factory(): m_bench(false), m_counters(false), m_benchSamples(15), m_benchSampleTime(10), m_timeout(0),
+    m_seed((unsigned long long)std::chrono::system_clock::now().time_since_epoch().count()),
+    m_iterations(100), m_shard(0), m_shards(1), m_fail(0), m_pass(0), m_slow(0) {}
   static bool EqualsSuiteName (std::string const &name, std::string const& s)
   {
     return name.find (':') >= name.length () - 2
       && s.substr (0, name.length ()) == name;
   }
+  // Shared between the runner and a watched test; the test thread may
+  // outlive the runner's interest in it when it hangs.
+  struct Watched
+  {
+    Watched(Create_t create, bool count): create(create), count(count), done(false) {}
+    Create_t create;
+    bool count;
+    std::mutex mutex;
+    std::condition_variable finished;
+    bool done;
+    std::exception_ptr error;
+    AllocationCount allocations;
+    Counters counters;
+  };
+  static void RunWatched(std::shared_ptr<Watched> watched)
+  {
+    std::exception_ptr error;
+    CounterMeter counterMeter(watched->count);
+    AllocationMeter meter;
+    try
+    {
+      watched->create();
+    }
+    catch(...)
+    {
+      error = std::current_exception();
+    }
+    const AllocationCount allocations = meter.Counted();
+    const Counters counters = counterMeter.Counted();
+    std::lock_guard<std::mutex> lock(watched->mutex);
+    watched->error = error;
+    watched->allocations = allocations;
+    watched->counters = counters;
+    watched->done = true;
+    watched->finished.notify_all();
+  }
 public:
   ~Factory(){}
   static Factory& Instance()
@@ -82,11 +545,278 @@ public:
     static Factory instance;
     return instance;
   }
-  void Register(const std::string& name, Create_t create)
+  void Register(const std::string& name, Create_t create, SharedFixture_t* fixture = 0)
   {
     m_Tests[name] = create;
+    if(fixture)
+    {
+      m_SharedFixtures[name] = fixture;
+    }
+  }
+  SharedFixture_t* SharedFixtureFor(const std::string& name) const
+  {
+    SharedFixtures_t::const_iterator it = m_SharedFixtures.find(name);
+    return it != m_SharedFixtures.end() ? it->second : 0;
+  }
+  // Tests are dealt to shards by their position in the full, sorted test
+  // list, so every shard process sees a stable, disjoint subset.
+  void Shard(size_t shard, size_t shards)
+  {
+    m_shard = shard;
+    m_shards = shards;
+  }
+  bool InShard(size_t index) const
+  {
+    return InShard(index, m_shard, m_shards);
+  }
+  static bool InShard(size_t index, size_t shard, size_t shards)
+  {
+    return index % shards == shard;
+  }
+  // per-test timeout in milliseconds, overrides the global one
+  void Timeout(const std::string& name, unsigned milliseconds)
+  {
+    m_Timeouts[name] = milliseconds;
+  }
+  // global timeout in milliseconds, 0 disables the watchdog
+  void Timeout(unsigned milliseconds)
+  {
+    m_timeout = milliseconds;
+  }
+  unsigned TimeoutFor(const std::string& name) const
+  {
+    Timeouts_t::const_iterator it = m_Timeouts.find(name);
+    return it != m_Timeouts.end() ? it->second : m_timeout;
+  }
+  // Benches are registered as tests, marked as benches, and run instead of
+  // the tests when asked for.
+  void MarkBench(const std::string& name)
+  {
+    m_Benches.insert(name);
+  }
+  bool IsBench(const std::string& name) const
+  {
+    return m_Benches.count(name) != 0;
+  }
+  void RunBenches(bool bench)
+  {
+    m_bench = bench;
+  }
+  // reports the performance counters of every test and bench
+  void CountEvents(bool count)
+  {
+    m_counters = count;
+  }
+  // samples per bench, each taking about 'milliseconds'
+  void BenchSamples(size_t samples, unsigned milliseconds)
+  {
+    m_benchSamples = samples;
+    m_benchSampleTime = milliseconds;
+  }
+  size_t BenchSamples() const
+  {
+    return m_benchSamples;
+  }
+  unsigned BenchSampleTime() const
+  {
+    return m_benchSampleTime;
+  }
+  // wall time in milliseconds a test is allowed, exceeding it is slow
+  void Budget(const std::string& name, unsigned milliseconds)
+  {
+    m_Budgets[name] = milliseconds;
+  }
+  unsigned BudgetFor(const std::string& name) const
+  {
+    Budgets_t::const_iterator it = m_Budgets.find(name);
+    return it != m_Budgets.end() ? it->second : 0;
+  }
+  // the time of a test of this run: its wall time, or per operation for a bench
+  void Measured(const std::string& name, double nanoseconds)
+  {
+    m_Measured[name] = nanoseconds;
+  }
+  const Baseline::Measured_t& Measured() const
+  {
+    return m_Measured;
+  }
+  // false, with the reason in 'error', unless 'path' is a baseline
+  bool ReadBaseline(const std::string& path, std::string& error)
+  {
+    std::ifstream is(path.c_str());
+    if(!is)
+    {
+      error = "cannot read " + path;
+      return false;
+    }
+    if(!m_baseline.Read(is, error))
+    {
+      error = path + " " + error;
+      return false;
+    }
+    return true;
+  }
+  bool WriteBaseline(const std::string& path) const
+  {
+    std::ofstream os(path.c_str());
+    m_baseline.Write(os, m_Measured);
+    return bool(os);
+  }
+  // compares the measured times with the baseline, a regression is slow
+  void CompareWithBaseline()
+  {
+    if(m_baseline.Size())
+    {
+      std::cout << std::endl << std::endl;
+      m_slow += m_baseline.Compare(m_Measured, std::cout);
+    }
+  }
+  // seed of all generated property inputs of this run
+  void Seed(unsigned long long seed)
+  {
+    m_seed = seed;
+  }
+  unsigned long long Seed() const
+  {
+    return m_seed;
+  }
+  // number of inputs checked for properties without a budget of their own
+  void Iterations(size_t iterations)
+  {
+    m_iterations = iterations;
+  }
+  size_t Iterations() const
+  {
+    return m_iterations;
+  }
+  // called with the report stream when a test hangs, e.g. to dump mock state
+  void AddHangReporter(HangReporter_t reporter)
+  {
+    if(std::find(m_HangReporters.begin(), m_HangReporters.end(), reporter)
+       == m_HangReporters.end())
+      m_HangReporters.push_back(reporter);
+  }
+  // The abandoned test may still be changing what the reporters look at, so
+  // they run in a forked copy of the process, where its thread does not run,
+  // and their report comes back through a pipe. A reporter that blocks, e.g.
+  // on a lock the test held when it hung, is given up on after 'milliseconds'.
+  void ReportHang(std::ostream& os, unsigned milliseconds = 2000) const
+  {
+    if(m_HangReporters.empty())
+    {
+      return;
+    }
+#ifdef __unix__
+    int report[2];
+    if(pipe(report) < 0)
+    {
+      return;
+    }
+    const pid_t child = fork();
+    if(child == 0)
+    {
+      close(report[0]);
+      std::ostringstream snapshot;
+      for(HangReporters_t::const_iterator it = m_HangReporters.begin(); it != m_HangReporters.end(); ++it)
+      {
+        (*it)(snapshot);
+      }
+      const std::string text = snapshot.str();
+      for(size_t written = 0; written < text.size(); )
+      {
+        const ssize_t n = write(report[1], text.data() + written, text.size() - written);
+        if(n <= 0)
+          _exit(1);
+        written += size_t(n);
+      }
+      _exit(0);
+    }
+    close(report[1]);
+    std::string text;
+    bool complete = false;
+    const std::chrono::steady_clock::time_point deadline =
+      std::chrono::steady_clock::now() + std::chrono::milliseconds(milliseconds);
+    while(child > 0)
+    {
+      const long long left = std::chrono::duration_cast<std::chrono::milliseconds>(
+        deadline - std::chrono::steady_clock::now()).count();
+      pollfd readable = { report[0], POLLIN, 0 };
+      if(left <= 0 || poll(&readable, 1, int(left)) == 0)
+        break;
+      char buffer[4096];
+      const ssize_t n = read(report[0], buffer, sizeof buffer);
+      if(n < 0 && errno == EINTR)
+        continue;
+      if(n <= 0)
+      {
+        complete = n == 0;
+        break;
+      }
+      text.append(buffer, size_t(n));
+    }
+    close(report[0]);
+    if(child > 0)
+    {
+      int status = 0;
+      if(!complete)
+        kill(child, SIGKILL);
+      waitpid(child, &status, 0);
+      complete = complete && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+    os << text;
+    if(!complete)
+      os << "  (the report on the hung test is incomplete)" << std::endl;
+#else
+    os << "  (no report on the hung test on this platform)" << std::endl;
+#endif
+  }
+  // Runs the test on a separate thread and waits at most 'milliseconds' for
+  // it. A test that does not finish in time is abandoned (its thread is
+  // detached, not killed) and timeout is thrown, so the run can go on.
+  // Returns what the test allocated on its thread, and fills 'counters'
+  // with the events it counted there, if given.
+  static AllocationCount RunWithWatchdog(Create_t create, unsigned milliseconds, Counters* counters = 0)
+  {
+    std::shared_ptr<Watched> watched(new Watched(create, counters != 0));
+    std::thread worker(&Factory::RunWatched, watched);
+    std::unique_lock<std::mutex> lock(watched->mutex);
+    const std::chrono::steady_clock::time_point deadline =
+      std::chrono::steady_clock::now() + std::chrono::milliseconds(milliseconds);
+    while(!watched->done)
+    {
+      if(watched->finished.wait_until(lock, deadline) == std::cv_status::timeout
+         && !watched->done)
+      {
+        lock.unlock();
+        worker.detach();
+        throw timeout(milliseconds);
+      }
+    }
+    lock.unlock();
+    worker.join();
+    if(watched->error)
+    {
+      std::rethrow_exception(watched->error);
+    }
+    if(counters)
+    {
+      *counters = watched->counters;
+    }
+    return watched->allocations;
+  }
+  static AllocationCount RunCounted(Create_t create, Counters* counters = 0)
+  {
+    CounterMeter counterMeter(counters != 0);
+    AllocationMeter meter;
+    create();
+    if(counters)
+    {
+      *counters = counterMeter.Counted();
+    }
+    return meter.Counted();
   }
   size_t Fail () { return m_fail; }
+  size_t Slow () { return m_slow; }
   void List(const std::string& name)
   {
     size_t i = 0;
@@ -100,43 +830,107 @@ public:
   }
   void Run(const std::string& name)
   {
-    int i = -1;
-    for(Tests_t::const_iterator it = m_Tests.begin(); it != m_Tests.end(); ++it)
+    Plan_t plan;
+    Select(name, plan);
+    Execute(plan);
+  }
+  // appends the tests matching 'name' (a test, a suite or "All") to the plan
+  void Select(const std::string& name, Plan_t& plan)
+  {
+    size_t i = 0;
+    for(Tests_t::const_iterator it = m_Tests.begin(); it != m_Tests.end(); ++it, ++i)
     {
-      ++i;
-      if("All" == name || it->first == name
-	 || EqualsSuiteName (name, it->first))
+      if(("All" == name || it->first == name
+	  || EqualsSuiteName (name, it->first))
+         && IsBench(it->first) == m_bench)
+      {
+        plan.push_back(Planned(i, it));
+      }
+    }
+  }
+  void Execute(const Plan_t& plan)
+  {
+    SharedFixtureLifetimes fixtures;
+    for(Plan_t::const_iterator p = plan.begin(); p != plan.end(); ++p)
+    {
+      if(InShard(p->index))
+      {
+        fixtures.Plan(SharedFixtureFor(p->test->first));
+      }
+    }
+    for(Plan_t::const_iterator p = plan.begin(); p != plan.end(); ++p)
+    {
+      if(!InShard(p->index))
+      {
+        continue;
+      }
+      Tests_t::const_iterator it = p->test;
+      SharedFixture_t* fixture = SharedFixtureFor(it->first);
+      try
       {
-        try
+        std::cout << std::endl << p->index << ") " << it->first << std::flush;
+        fixtures.Begin(fixture);
+        const unsigned milliseconds = TimeoutFor(it->first);
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        Counters counters;
+        Counters* counted = m_counters ? &counters : 0;
+        const AllocationCount allocations = milliseconds
+          ? RunWithWatchdog(it->second, milliseconds, counted) : RunCounted(it->second, counted);
+        const double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        std::cout << " [OK]";
+        if(AllocationsCounted())
         {
-          std::cout << std::endl << i << ") " << it->first << std::flush;
-          {
-            it->second();
-          }
-          std::cout << " [OK]" << std::flush;
-          ++m_pass;
+          std::cout << " (" << allocations.allocations << " allocations, "
+                    << allocations.bytes << " bytes)";
         }
-        catch(const std::exception& e)
+        if(m_counters)
         {
-          std::cout << " [FAIL]\n  " << e.what() << std::flush;
-          ++m_fail;
+          std::cout << " (" << counters << ")";
         }
-        catch(...)
+        if(!IsBench(it->first))
         {
-          std::cout << " [FAIL]\n  unknown exception" << std::flush;
-          ++m_fail;
+          Measured(it->first, elapsed);
         }
+        const unsigned budget = BudgetFor(it->first);
+        if(budget && elapsed > budget * 1e6)
+        {
+          std::cout << " [SLOW] " << Duration(elapsed) << " over the budget of " << budget << " ms";
+          ++m_slow;
+        }
+        std::cout << std::flush;
+        ++m_pass;
+      }
+      catch(const timeout& e)
+      {
+        std::cout << " [TIMEOUT]\n  " << e.what() << std::endl;
+        ReportHang(std::cout);
+        std::cout << std::flush;
+        ++m_fail;
+        fixtures.Abandon(fixture);
+      }
+      catch(const std::exception& e)
+      {
+        std::cout << " [FAIL]\n  " << e.what() << std::flush;
+        ++m_fail;
       }
+      catch(...)
+      {
+        std::cout << " [FAIL]\n  unknown exception" << std::flush;
+        ++m_fail;
+      }
+      fixtures.End(fixture);
     }
   }
   void Report ()
   {
-    const size_t size = m_Tests.size();
+    const size_t size = m_bench ? m_Benches.size() : m_Tests.size() - m_Benches.size();
     std::cout << std::endl;
     std::cout << "[TOTAL](" << m_pass + m_fail << '/' << size << ")" << std::endl;
     std::cout << "[OK](" << m_pass << '/' << size << ")" << std::endl;
     if (m_fail)
       std::cout << "[FAIL](" << m_fail << '/' << size << ")" << std::endl;
+    if (m_slow)
+      std::cout << "[SLOW](" << m_slow << ")" << std::endl;
   }
   int Main (int argc, const char* argv[])
   {
@@ -146,9 +940,19 @@ public:
       std::cout << "Yaffut - Yet Another Framework For Unit Testing.\n\n"
 	"Usage: yaffut [OPTION] [Suite:|Suite::Test]...\n\n"
 	"Options:\n"
-	"  -h, --help     show this help\n"
-	"  -l, --list     list test cases\n"
-	"  -v, --version  show version number\n"
+	"  -h, --help          show this help\n"
+	"  -l, --list          list test cases\n"
+	"  -v, --version       show version number\n"
+	"  -t, --timeout MS    abandon tests running longer than MS milliseconds\n"
+	"      --shard I/N     run only the I-th (0-based) of N shards of the tests\n"
+	"      --seed N        seed for the generated inputs of properties\n"
+	"      --iterations N  inputs checked per property (default 100)\n"
+	"      --bench         run the benches instead of the tests\n"
+	"      --bench-samples N[/MS]  N samples of MS milliseconds per bench (default 15/10)\n"
+	"      --counters      report IPC and miss rates of the tests from perf events\n"
+	"      --baseline FILE       fail tests slower than in FILE by more than its tolerance\n"
+	"      --write-baseline FILE write the times of this run to FILE\n"
+	"\nExits with the number of failures, or 250 when only times failed.\n"
 		<< std::flush;
       return 0;
     }
@@ -169,20 +973,90 @@ public:
     std::cout << "pid(" << getpid() << ")" << std::endl;
 #endif
 
-    const char* all[] = {"All"};
-    const char** test = all;
-    int num = 1;
-    if(1 < argc)
+    std::vector<std::string> tests;
+    std::string writeBaseline;
+    for(int i = 1; i < argc; ++i)
+    {
+      const std::string arg(argv[i]);
+      if(arg == "--baseline" && i + 1 < argc)
+      {
+        std::string error;
+        if(!Factory::Instance().ReadBaseline(argv[++i], error))
+        {
+          std::cerr << "invalid baseline " << error << std::endl;
+          return -1;
+        }
+        continue;
+      }
+      if(arg == "--write-baseline" && i + 1 < argc)
+      {
+        writeBaseline = argv[++i];
+        continue;
+      }
+      if((arg == "-t" || arg == "--timeout") && i + 1 < argc)
+      {
+        Factory::Instance().Timeout(unsigned(std::strtoul(argv[++i], 0, 10)));
+        continue;
+      }
+      if(arg == "--seed" && i + 1 < argc)
+      {
+        Factory::Instance().Seed(std::strtoull(argv[++i], 0, 10));
+        continue;
+      }
+      if(arg == "--iterations" && i + 1 < argc)
+      {
+        Factory::Instance().Iterations(std::strtoul(argv[++i], 0, 10));
+        continue;
+      }
+      if(arg == "--bench")
+      {
+        Factory::Instance().RunBenches(true);
+        continue;
+      }
+      if(arg == "--counters")
+      {
+        Factory::Instance().CountEvents(true);
+        continue;
+      }
+      if(arg == "--bench-samples" && i + 1 < argc)
+      {
+        char* of = 0;
+        const size_t samples = std::strtoul(argv[++i], &of, 10);
+        const unsigned milliseconds = (of && *of == '/') ? unsigned(std::strtoul(of + 1, 0, 10)) : Factory::Instance().BenchSampleTime();
+        if(samples == 0 || milliseconds == 0)
+        {
+          std::cerr << "invalid bench samples " << argv[i] << ", expected N or N/MS" << std::endl;
+          return -1;
+        }
+        Factory::Instance().BenchSamples(samples, milliseconds);
+        continue;
+      }
+      if(arg == "--shard" && i + 1 < argc)
+      {
+        char* of = 0;
+        const size_t shard = std::strtoul(argv[++i], &of, 10);
+        const size_t shards = (of && *of == '/') ? std::strtoul(of + 1, 0, 10) : 0;
+        if(shards == 0 || shard >= shards)
+        {
+          std::cerr << "invalid shard " << argv[i] << ", expected I/N with I < N" << std::endl;
+          return -1;
+        }
+        Factory::Instance().Shard(shard, shards);
+        continue;
+      }
+      tests.push_back(arg);
+    }
+    if(tests.empty())
     {
-      test = argv;
-      num = argc;
+      tests.push_back("All");
     }
     
-    for(int i = 0; i < num; ++i)
+    Plan_t plan;
+    for(size_t i = 0; i < tests.size(); ++i)
     {
       try
       {
-	std::istringstream is(test[i]);
+	std::istringstream is(tests[i]);
 	int num;
 	is >> num;
 	if(is)
@@ -191,12 +1065,12 @@ public:
 	  {
 	    Tests_t::const_iterator it = m_Tests.begin();
             while(0 <= --num){++it;}
-	    Factory::Instance().Run(it->first);
+	    Factory::Instance().Select(it->first, plan);
 	  }
 	}
         else
 	{
-	  Factory::Instance().Run(test[i]);
+	  Factory::Instance().Select(tests[i], plan);
 	}
       }
       catch(const std::exception& e)
@@ -204,9 +1078,19 @@ public:
 	std::clog << e.what() << std::endl;
       }
     }
+    Factory::Instance().Execute(plan);
+    Factory::Instance().CompareWithBaseline();
+    if(!writeBaseline.empty() && !Factory::Instance().WriteBaseline(writeBaseline))
+    {
+      std::cerr << "cannot write baseline " << writeBaseline << std::endl;
+    }
 
     Factory::Instance().Report ();
-    return Factory::Instance().Fail ();
+    if(Factory::Instance().Fail ())
+    {
+      return int(std::min(Factory::Instance().Fail (), size_t(PerformanceFailure - 1)));
+    }
+    return Factory::Instance().Slow () ? PerformanceFailure : 0;
   }
 };
 
@@ -217,30 +1101,113 @@ public:
   template <typename Expected, typename Actual>
   failure(const Expected& e, Actual& a, const char* at = "", const char* expr = "")
   {
-    std::ostringstream os;
-    os << at << expr << "\nexpected: "
-       << "(" << demangle<Expected>() << ") " << e
-       << " != actual: " << "(" << demangle<Actual>() << ") " << a;
-    failure_ = os.str();
+    std::ostringstream os;
+    os << at << expr << "\nexpected: "
+       << "(" << demangle<Expected>() << ") " << e
+       << " != actual: " << "(" << demangle<Actual>() << ") " << a;
+    failure_ = os.str();
+  }
+  failure(const char* at = "", const char* expr = "")
+  {
+    std::ostringstream os;
+    os << at << expr;
+    failure_ = os.str();
+  }
+  virtual ~failure() throw() {}
+  virtual const char* what() const throw() { return failure_.c_str(); }
+};
+
+// ASSERT_MAX_ALLOCS(n) { ... } runs the block once and fails if it
+// allocated more than n times on this thread. Leaving the block with break,
+// return or an exception skips the check.
+class AllocationScope
+{
+  AllocationMeter m_meter;
+  unsigned long long m_limit;
+  const char* m_at;
+  const char* m_expr;
+  bool m_entered;
+public:
+  AllocationScope(unsigned long long limit, const char* at, const char* expr)
+    : m_limit(limit), m_at(at), m_expr(expr), m_entered(false)
+  {
+    if(!AllocationsCounted())
+      throw failure(at, "allocations are not counted, define YAFFUT_TRACK_ALLOCATIONS where main() is defined");
+  }
+  // true before the block, false after it
+  bool Enter()
+  {
+    if(!m_entered)
+    {
+      m_entered = true;
+      return true;
+    }
+    const AllocationCount counted = m_meter.Counted();
+    if(counted.allocations > m_limit)
+    {
+      std::ostringstream os;
+      os << m_expr << "failed: " << counted.allocations << " allocations, "
+         << counted.bytes << " bytes";
+      throw failure(m_at, os.str().c_str());
+    }
+    return false;
+  }
+};
+
+// Opt-in suite-scoped fixture: derive the suite from SuiteFixture<T> and T
+// is constructed once before the first test of the suite that is run and
+// destroyed after the last one. Tests reach it through Shared(); the suite
+// itself is still constructed for every test.
+template <typename T>
+struct SuiteFixture
+{
+  static T& Shared()
+  {
+    return *Instance();
+  }
+  static SharedFixture_t* Lifetime()
+  {
+    static SharedFixture_t lifetime = { &SetUp, &TearDown, false };
+    return &lifetime;
   }
-  failure(const char* at = "", const char* expr = "")
+private:
+  static T*& Instance()
   {
-    std::ostringstream os;
-    os << at << expr;
-    failure_ = os.str();
+    static T* instance = 0;
+    return instance;
+  }
+  static void SetUp()
+  {
+    if(!Instance())
+    {
+      Instance() = new T();
+    }
+  }
+  static void TearDown()
+  {
+    delete Instance();
+    Instance() = 0;
   }
-  virtual ~failure() throw() {}
-  virtual const char* what() const throw() { return failure_.c_str(); }
 };
 
+template <typename T>
+SharedFixture_t* SharedFixtureOf(SuiteFixture<T>*)
+{
+  return SuiteFixture<T>::Lifetime();
+}
+inline SharedFixture_t* SharedFixtureOf(...)
+{
+  return 0;
+}
+
 template <typename Suite, typename Case>
 struct Registrator
 {
   Registrator()
   {
-    Factory::Instance().Register(TestName(), Create);
+    Factory::Instance().Register(TestName(), Create, SharedFixtureOf(static_cast<Suite*>(0)));
   }
-  const std::string& TestName()
+  static const std::string& TestName()
   {
     static const std::string name(demangle<Suite>() + "::" + demangle<Case>());
     return name;
@@ -258,7 +1225,7 @@ struct Registrator<Case, void>
   {
     Factory::Instance().Register(TestName(), Create);
   }
-  const std::string& TestName()
+  static const std::string& TestName()
   {
     static const std::string name ("::" + demangle<Case>());
     return name;
@@ -269,6 +1236,24 @@ struct Registrator<Case, void>
   }
 };
 
+template <typename Suite, typename Case>
+struct TimeoutRegistrator
+{
+  TimeoutRegistrator(unsigned milliseconds)
+  {
+    Factory::Instance().Timeout(Registrator<Suite, Case>::TestName(), milliseconds);
+  }
+};
+
+template <typename Suite, typename Case>
+struct BudgetRegistrator
+{
+  BudgetRegistrator(unsigned milliseconds)
+  {
+    Factory::Instance().Budget(Registrator<Suite, Case>::TestName(), milliseconds);
+  }
+};
+
 template <typename Suite, typename Case = void>
 struct Test: public virtual Suite
 {
@@ -393,6 +1378,466 @@ void assert_throw(T* pt, void(T::*mf)(), const char* at = "")
   catch(const E&){}
 }
 
+// Property based testing: a property is checked against inputs drawn from
+// generators. All randomness comes from one seed, so a failing property can
+// be replayed exactly with --seed; failing inputs are shrunk before they are
+// reported.
+class Random
+{
+  unsigned long long m_state;
+public:
+  explicit Random(unsigned long long seed): m_state(seed) {}
+  // splitmix64, identical on every platform
+  unsigned long long Next()
+  {
+    unsigned long long z = (m_state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+  }
+  size_t Below(size_t bound)
+  {
+    return bound ? size_t(Next() % bound) : 0;
+  }
+};
+
+inline unsigned long long SeedFor(unsigned long long seed, const std::string& name)
+{
+  // FNV-1a, so a property sees the same inputs whatever else is run
+  unsigned long long hash = 14695981039346656037ULL;
+  for(std::string::const_iterator c = name.begin(); c != name.end(); ++c)
+  {
+    hash = (hash ^ (unsigned char)(*c)) * 1099511628211ULL;
+  }
+  return seed ^ hash;
+}
+
+namespace gen {
+
+template <typename T>
+class Integral
+{
+  typedef typename std::make_unsigned<T>::type U;
+  T m_min;
+  T m_max;
+  // the value shrinking moves towards: the one closest to zero
+  T Target() const
+  {
+    return m_min > 0 ? m_min : (m_max < 0 ? m_max : T(0));
+  }
+public:
+  typedef T value_type;
+  Integral(T min, T max): m_min(min), m_max(max) {}
+  T operator()(Random& random) const
+  {
+    const U span = U(U(m_max) - U(m_min) + 1);
+    return T(U(m_min) + (span ? U(random.Next() % span) : U(random.Next())));
+  }
+  void Shrink(const T& value, std::vector<T>& candidates) const
+  {
+    const T target = Target();
+    const U distance = value > target ? U(U(value) - U(target)) : U(U(target) - U(value));
+    for(U step = distance; step != 0; step /= 2)
+    {
+      candidates.push_back(value > target ? T(U(value) - step) : T(U(value) + step));
+    }
+  }
+};
+
+inline Integral<int> Int(int min, int max)
+{
+  return Integral<int>(min, max);
+}
+
+class Bool
+{
+public:
+  typedef bool value_type;
+  bool operator()(Random& random) const
+  {
+    return (random.Next() & 1) != 0;
+  }
+  void Shrink(bool value, std::vector<bool>& candidates) const
+  {
+    if(value)
+      candidates.push_back(false);
+  }
+};
+
+class String
+{
+  size_t m_maxLength;
+  std::string m_alphabet;
+public:
+  typedef std::string value_type;
+  explicit String(size_t maxLength, const std::string& alphabet = "abcdefghijklmnopqrstuvwxyz0123456789")
+    : m_maxLength(maxLength), m_alphabet(alphabet) {}
+  std::string operator()(Random& random) const
+  {
+    std::string value(random.Below(m_maxLength + 1), ' ');
+    for(std::string::iterator c = value.begin(); c != value.end(); ++c)
+    {
+      *c = m_alphabet[random.Below(m_alphabet.size())];
+    }
+    return value;
+  }
+  void Shrink(const std::string& value, std::vector<std::string>& candidates) const
+  {
+    if(value.empty())
+      return;
+    candidates.push_back(std::string());
+    candidates.push_back(value.substr(0, value.size() / 2));
+    for(size_t i = 0; i < value.size(); ++i)
+    {
+      candidates.push_back(value.substr(0, i) + value.substr(i + 1));
+    }
+    for(size_t i = 0; i < value.size(); ++i)
+    {
+      if(value[i] != m_alphabet[0])
+      {
+        std::string simpler(value);
+        simpler[i] = m_alphabet[0];
+        candidates.push_back(simpler);
+      }
+    }
+  }
+};
+
+template <typename G>
+class VectorOf
+{
+  G m_element;
+  size_t m_maxLength;
+public:
+  typedef std::vector<typename G::value_type> value_type;
+  VectorOf(const G& element, size_t maxLength): m_element(element), m_maxLength(maxLength) {}
+  value_type operator()(Random& random) const
+  {
+    value_type value;
+    const size_t length = random.Below(m_maxLength + 1);
+    value.reserve(length);
+    for(size_t i = 0; i < length; ++i)
+    {
+      value.push_back(m_element(random));
+    }
+    return value;
+  }
+  void Shrink(const value_type& value, std::vector<value_type>& candidates) const
+  {
+    if(value.empty())
+      return;
+    candidates.push_back(value_type());
+    candidates.push_back(value_type(value.begin(), value.begin() + value.size() / 2));
+    for(size_t i = 0; i < value.size(); ++i)
+    {
+      value_type shorter(value);
+      shorter.erase(shorter.begin() + i);
+      candidates.push_back(shorter);
+    }
+    for(size_t i = 0; i < value.size(); ++i)
+    {
+      std::vector<typename G::value_type> elements;
+      m_element.Shrink(value[i], elements);
+      if(!elements.empty())
+      {
+        value_type simpler(value);
+        simpler[i] = elements.front();
+        candidates.push_back(simpler);
+      }
+    }
+  }
+};
+
+template <typename G>
+VectorOf<G> Vector(const G& element, size_t maxLength)
+{
+  return VectorOf<G>(element, maxLength);
+}
+
+}
+
+template <typename T>
+void Show(std::ostream& os, const T& value)
+{
+  os << value;
+}
+inline void Show(std::ostream& os, bool value)
+{
+  os << (value ? "true" : "false");
+}
+inline void Show(std::ostream& os, const std::string& value)
+{
+  os << '"' << value << '"';
+}
+template <typename T>
+void Show(std::ostream& os, const std::vector<T>& value)
+{
+  os << '[';
+  for(size_t i = 0; i < value.size(); ++i)
+  {
+    if(i)
+      os << ", ";
+    Show(os, value[i]);
+  }
+  os << ']';
+}
+
+template <typename... G>
+struct Property
+{
+  typedef void Check_t(typename G::value_type...);
+  typedef std::tuple<typename G::value_type...> Input_t;
+};
+template <typename... G>
+Property<G...> PropertyOf(const G&...);
+
+template <size_t K, size_t N>
+struct PropertyArguments
+{
+  template <typename Input>
+  static void Show(std::ostream& os, const Input& input)
+  {
+    os << (K ? ", " : "");
+    yaffut::Show(os, std::get<K>(input));
+    PropertyArguments<K + 1, N>::Show(os, input);
+  }
+  // tries the shrink candidates of argument K and then of the following
+  // ones; takes the first candidate that still fails
+  template <typename Input, typename Fails, typename Generators>
+  static bool Shrink(Input& input, Fails& fails, const Generators& generators)
+  {
+    typedef typename std::tuple_element<K, Input>::type Value;
+    std::vector<Value> candidates;
+    std::get<K>(generators).Shrink(std::get<K>(input), candidates);
+    for(typename std::vector<Value>::const_iterator c = candidates.begin(); c != candidates.end(); ++c)
+    {
+      Input candidate(input);
+      std::get<K>(candidate) = *c;
+      if(fails(candidate))
+      {
+        input = candidate;
+        return true;
+      }
+    }
+    return PropertyArguments<K + 1, N>::Shrink(input, fails, generators);
+  }
+};
+template <size_t N>
+struct PropertyArguments<N, N>
+{
+  template <typename Input>
+  static void Show(std::ostream&, const Input&) {}
+  template <typename Input, typename Fails, typename Generators>
+  static bool Shrink(Input&, Fails&, const Generators&) { return false; }
+};
+
+// Puts the fixture back before each input, when it has a Reset(), so that
+// what a failing input left behind, e.g. unmet expectations, does not fail
+// the inputs after it.
+template <typename T>
+auto ResetFixture(T& object, int) -> decltype(object.Reset(), void())
+{
+  object.Reset();
+}
+template <typename T>
+void ResetFixture(T&, long) {}
+
+template <typename T, typename Input, typename... V>
+class PropertyCheck
+{
+  T& m_object;
+  void (T::*m_check)(V...);
+  template <size_t... I>
+  void Apply(const Input& input, std::index_sequence<I...>)
+  {
+    (m_object.*m_check)(std::get<I>(input)...);
+  }
+public:
+  std::string message;
+  PropertyCheck(T& object, void (T::*check)(V...)): m_object(object), m_check(check) {}
+  bool operator()(const Input& input)
+  {
+    try
+    {
+      ResetFixture(m_object, 0);
+      Apply(input, std::index_sequence_for<V...>());
+      return false;
+    }
+    catch(const std::exception& e)
+    {
+      message = e.what();
+    }
+    catch(...)
+    {
+      message = "unknown exception";
+    }
+    return true;
+  }
+};
+
+const size_t PropertyBatchSize = 64;
+const size_t PropertyMaxShrinks = 1000;
+
+// Checks 'iterations' generated inputs against 'check', always on the same
+// object, so fixtures such as a MockRepository are reused between inputs;
+// its Reset(), if any, is called before every input and shrink candidate.
+template <typename T, typename... V, typename... G>
+void CheckProperty(T& object, void (T::*check)(V...), size_t iterations,
+                   unsigned long long seed, const std::string& name, const G&... generators)
+{
+  typedef typename Property<G...>::Input_t Input;
+  const std::tuple<G...> all(generators...);
+  Random random(SeedFor(seed, name));
+  PropertyCheck<T, Input, V...> fails(object, check);
+  std::vector<Input> batch;
+  batch.reserve(PropertyBatchSize);
+  for(size_t done = 0; done < iterations; done += batch.size())
+  {
+    batch.clear();
+    for(size_t i = 0; i < PropertyBatchSize && done + i < iterations; ++i)
+    {
+      // braced initialisation draws the arguments left to right
+      batch.push_back(Input{generators(random)...});
+    }
+    for(size_t i = 0; i < batch.size(); ++i)
+    {
+      if(!fails(batch[i]))
+        continue;
+      const std::string original(fails.message);
+      Input shrunk(batch[i]);
+      for(size_t step = 0; step < PropertyMaxShrinks
+          && PropertyArguments<0, sizeof...(G)>::Shrink(shrunk, fails, all); ++step) {}
+      if(!fails(shrunk))
+        fails.message = original;
+      std::ostringstream os;
+      os << "property falsified by input " << done + i + 1 << " of " << iterations
+         << " (seed " << seed << ", replay with --seed " << seed << ")\n  input: (";
+      PropertyArguments<0, sizeof...(G)>::Show(os, batch[i]);
+      os << ")\n  shrunk: (";
+      PropertyArguments<0, sizeof...(G)>::Show(os, shrunk);
+      os << ")\n  " << fails.message;
+      throw failure(os.str().c_str());
+    }
+  }
+}
+
+// Micro-benchmarks: BENCH(Suite, Case) { body } times the body as one
+// operation, on a suite that is constructed once for all the operations.
+// The operations per sample are calibrated to the sample time, one sample
+// is run to warm up, and the result is the median and the median absolute
+// deviation of the time per operation over the samples.
+struct BenchResult
+{
+  unsigned long long iterations;
+  size_t samples;
+  double median;
+  double mad;
+};
+
+inline std::ostream& operator<<(std::ostream& os, const BenchResult& result)
+{
+  return os << result.median << " ns/op (MAD " << result.mad << " ns, "
+            << result.samples << " samples of " << result.iterations << " ops)";
+}
+
+inline double Median(std::vector<double> values)
+{
+  if(values.empty())
+    return 0;
+  std::sort(values.begin(), values.end());
+  const size_t middle = values.size() / 2;
+  return values.size() % 2 ? values[middle] : (values[middle - 1] + values[middle]) / 2;
+}
+
+inline double MedianAbsoluteDeviation(const std::vector<double>& values)
+{
+  const double median = Median(values);
+  std::vector<double> deviations;
+  deviations.reserve(values.size());
+  for(std::vector<double>::const_iterator v = values.begin(); v != values.end(); ++v)
+  {
+    deviations.push_back(std::abs(*v - median));
+  }
+  return Median(deviations);
+}
+
+// keeps 'value' from being optimised away, as if it were read
+template <typename T>
+inline void DoNotOptimize(const T& value)
+{
+#ifdef __GNUC__
+  asm volatile("" : : "r,m"(value) : "memory");
+#else
+  static const void* volatile sink;
+  sink = &value;
+#endif
+}
+
+// makes the compiler assume all memory was read and written
+inline void ClobberMemory()
+{
+#ifdef __GNUC__
+  asm volatile("" : : : "memory");
+#else
+  std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+}
+
+// nanoseconds taken by 'iterations' operations
+template <typename T>
+double TimeOperations(T& object, void (T::*operation)(), unsigned long long iterations)
+{
+  const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for(unsigned long long i = 0; i < iterations; ++i)
+  {
+    (object.*operation)();
+  }
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+template <typename T>
+BenchResult RunBench(T& object, void (T::*operation)(), size_t samples, unsigned sampleMilliseconds)
+{
+  const double sampleTime = sampleMilliseconds * 1e6;
+  // doubles the operations until they take a tenth of a sample, then
+  // scales them up to a whole one
+  unsigned long long iterations = 1;
+  double elapsed = TimeOperations(object, operation, iterations);
+  while(elapsed < sampleTime / 10 && iterations < (1ULL << 40))
+  {
+    iterations *= 2;
+    elapsed = TimeOperations(object, operation, iterations);
+  }
+  iterations = std::max(1ULL, (unsigned long long)(iterations * sampleTime / std::max(elapsed, 1.0)));
+  TimeOperations(object, operation, iterations);
+  std::vector<double> perOperation;
+  perOperation.reserve(samples);
+  for(size_t s = 0; s < samples; ++s)
+  {
+    perOperation.push_back(TimeOperations(object, operation, iterations) / iterations);
+  }
+  BenchResult result = { iterations, samples, Median(perOperation), MedianAbsoluteDeviation(perOperation) };
+  return result;
+}
+
+template <typename T>
+void Bench(T& object, void (T::*operation)(), const std::string& name)
+{
+  Factory& factory = Factory::Instance();
+  const BenchResult result = RunBench(object, operation, factory.BenchSamples(), factory.BenchSampleTime());
+  factory.Measured(name, result.median);
+  std::cout << ' ' << result << std::flush;
+}
+
+template <typename Suite, typename Case>
+struct BenchRegistrator
+{
+  BenchRegistrator()
+  {
+    Factory::Instance().MarkBench(Registrator<Suite, Case>::TestName());
+  }
+};
+
 inline int
 main (int argc, const char* argv[])
 {
@@ -406,6 +1851,47 @@ main (int argc, const char* argv[])
   namespace { struct Case: public yaffut::Test<Suite, Case>{ Case(); }; } \
   Case::Case()
 
+#define TEST_TIMEOUT(Suite, Case, milliseconds)\
+  namespace { struct Case: public yaffut::Test<Suite, Case>{ Case(); }; \
+  yaffut::TimeoutRegistrator<Suite, Case> Case##Timeout(milliseconds); } \
+  Case::Case()
+
+// a test that passes slower than 'milliseconds' fails the run's times
+#define TEST_BUDGET(Suite, Case, milliseconds)\
+  namespace { struct Case: public yaffut::Test<Suite, Case>{ Case(); }; \
+  yaffut::BudgetRegistrator<Suite, Case> Case##Budget(milliseconds); } \
+  Case::Case()
+
+// PROPERTY(Suite, Case, generators...)(T1 a1, T2 a2...) { body }
+// checks the body against inputs drawn from the generators; the parameter
+// types are the generators' value types. PROPERTY_N sets the number of inputs.
+#define PROPERTY_N(Suite, Case, iterations, ...)\
+  namespace { struct Case: public yaffut::Test<Suite, Case>{ \
+    typedef decltype(yaffut::PropertyOf(__VA_ARGS__))::Check_t Check_t; \
+    Check_t Check; \
+    Case() \
+    { \
+      const size_t budget = iterations; \
+      yaffut::CheckProperty(*this, &Case::Check, \
+        budget ? budget : yaffut::Factory::Instance().Iterations(), \
+        yaffut::Factory::Instance().Seed(), \
+        yaffut::Registrator<Suite, Case>::TestName(), __VA_ARGS__); \
+    } }; } \
+  void Case::Check
+
+#define PROPERTY(Suite, Case, ...) PROPERTY_N(Suite, Case, 0, __VA_ARGS__)
+
+// BENCH(Suite, Case) { one operation } is run with --bench only.
+#define BENCH(Suite, Case)\
+  namespace { struct Case: public yaffut::Test<Suite, Case>{ \
+    void Operation(); \
+    Case() \
+    { \
+      yaffut::Bench(*this, &Case::Operation, yaffut::Registrator<Suite, Case>::TestName()); \
+    } }; \
+  yaffut::BenchRegistrator<Suite, Case> Case##Bench; } \
+  void Case::Operation()
+
 #define FUNC(Case)\
   namespace { struct Case: public yaffut::Test<Case>{ Case(); }; } \
   Case::Case()
@@ -456,6 +1942,74 @@ main (int argc, const char* argv[])
 #define ASSERT_THROW YAFFUT_ASSERT_THROW
 #endif
 
+#define YAFFUT_ASSERT_MAX_ALLOCS(n) \
+  for(yaffut::AllocationScope yaffut_allocations((n), __YAFFUT_AT__, "ASSERT_MAX_ALLOCS(" #n ") "); \
+      yaffut_allocations.Enter(); )
+#ifndef ASSERT_MAX_ALLOCS
+#define ASSERT_MAX_ALLOCS YAFFUT_ASSERT_MAX_ALLOCS
+#endif
+
+#define YAFFUT_ASSERT_NO_ALLOC \
+  for(yaffut::AllocationScope yaffut_allocations(0, __YAFFUT_AT__, "ASSERT_NO_ALLOC "); \
+      yaffut_allocations.Enter(); )
+#ifndef ASSERT_NO_ALLOC
+#define ASSERT_NO_ALLOC YAFFUT_ASSERT_NO_ALLOC
+#endif
+
+#ifdef YAFFUT_TRACK_ALLOCATIONS
+namespace yaffut {
+namespace {
+struct AllocationTracking
+{
+  AllocationTracking() { AllocationsCounted() = true; }
+} allocationTracking;
+}
+// 0 when out of memory and the new handler gives up
+inline void* CountedAllocation(std::size_t size)
+{
+  CountAllocation(size);
+  for(;;)
+  {
+    if(void* p = std::malloc(size ? size : 1))
+      return p;
+    std::new_handler handler = std::get_new_handler();
+    if(!handler)
+      return 0;
+    handler();
+  }
+}
+}
+
+void* operator new(std::size_t size)
+{
+  if(void* p = yaffut::CountedAllocation(size))
+    return p;
+  throw std::bad_alloc();
+}
+void* operator new[](std::size_t size)
+{
+  if(void* p = yaffut::CountedAllocation(size))
+    return p;
+  throw std::bad_alloc();
+}
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+  try { return yaffut::CountedAllocation(size); } catch(...) { return 0; }
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+  try { return yaffut::CountedAllocation(size); } catch(...) { return 0; }
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+#ifdef __cpp_sized_deallocation
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+#endif
+#endif /* YAFFUT_TRACK_ALLOCATIONS */
+
 #ifdef YAFFUT_MAIN
 #include <iostream>
 int main(int argc, const char* argv[])
@@ -464,4 +2018,8 @@ int main(int argc, const char* argv[])
 };
 #endif /* YAFFUT_MAIN */
 
+#ifdef TINYMOCK_H
+#include "TinyMockYaffut.h"
+#endif
+
 #endif
@@ -1,9 +1,10 @@
 //#include "stdafx.h"
 #include <iostream>
+#define YAFFUT_TRACK_ALLOCATIONS
 #include "yaffut.h"
 using namespace std;
 
 int main(int argc, const char* argv[])
 {
-	yaffut::main(argc,argv);
+	return yaffut::main(argc,argv);
 }
@@ -0,0 +1,15 @@
+// The TinyMock library, for programs built with TINYMOCK_LEAN: what prints,
+// and the common Method types, compiled once.
+
+#ifndef TINYMOCK_LEAN
+#define TINYMOCK_LEAN
+#endif
+#include "TinyMockImpl.h"
+
+namespace TinyMock {
+
+#define TINYMOCK_INSTANTIATE_METHOD(...) template class __VA_ARGS__ ;
+TINYMOCK_COMMON_METHODS(TINYMOCK_INSTANTIATE_METHOD)
+#undef TINYMOCK_INSTANTIATE_METHOD
+
+}